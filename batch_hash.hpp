@@ -0,0 +1,173 @@
+/**
+ * batched bucket-index computation for linked_hashmap.
+ *
+ * For 32/64-bit integer keys hashed by std::hash (an identity cast on
+ * libstdc++ and libc++), the bucket index of a whole batch is computed
+ * with AVX2, four keys per instruction; the AVX2 kernel is picked at
+ * runtime and every other case falls back to a scalar loop.
+ * The kernels implement the reductions of pow2_index and prime_index
+ * (index_policy.hpp).
+ */
+#ifndef SJTU_BATCH_HASH_HPP
+#define SJTU_BATCH_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SJTU_BATCH_HASH_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace sjtu {
+namespace detail {
+
+/**
+ * whether Key under Hash may be fed to an index policy's
+ * index_integers(), i.e. Hash is std::hash of a 32/64-bit integer and
+ * the standard library implements it as an identity cast.
+ */
+template<class Key, class Hash>
+struct batch_hashable : std::integral_constant<bool,
+#if defined(__GLIBCXX__) || defined(_LIBCPP_VERSION)
+	std::is_same<Hash, std::hash<Key> >::value && std::is_integral<Key>::value &&
+	!std::is_same<Key, bool>::value && (sizeof(Key) == 4 || sizeof(Key) == 8)
+#else
+	false
+#endif
+> {};
+
+inline bool cpu_has_avx2() {
+#ifdef SJTU_BATCH_HASH_AVX2
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+#else
+	return false;
+#endif
+}
+
+// 2^64 / golden ratio, the multiplier of Fibonacci hashing
+const std::uint64_t FIBONACCI_MULTIPLIER = 0x9E3779B97F4A7C15ull;
+
+#ifdef SJTU_BATCH_HASH_AVX2
+// out[i] = (keys[i] * FIBONACCI_MULTIPLIER) >> shift, with keys[i]
+// widened to 64 bits the way the identity std::hash casts it.
+template<class Key>
+__attribute__((target("avx2")))
+void batch_fibonacci_index_avx2(const Key *keys, size_t n, unsigned shift, size_t *out) {
+	// AVX2 has no 64-bit multiply; build the low half from 32-bit products
+	const __m256i mul = _mm256_set1_epi64x((long long)FIBONACCI_MULTIPLIER);
+	const __m256i mul_hi = _mm256_srli_epi64(mul, 32);
+	const __m128i count = _mm_cvtsi32_si128((int)shift);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256i h;
+		if constexpr (sizeof(Key) == 4) {
+			__m128i k = _mm_loadu_si128((const __m128i *)(keys + i));
+			h = std::is_signed<Key>::value ? _mm256_cvtepi32_epi64(k) : _mm256_cvtepu32_epi64(k);
+		} else {
+			h = _mm256_loadu_si256((const __m256i *)(keys + i));
+		}
+		__m256i low = _mm256_mul_epu32(h, mul);
+		__m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(h, 32), mul),
+		                                 _mm256_mul_epu32(h, mul_hi));
+		__m256i product = _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_srl_epi64(product, count));
+	}
+	for (; i < n; ++i) {
+		out[i] = (size_t)(((std::uint64_t)(size_t)keys[i] * FIBONACCI_MULTIPLIER) >> shift);
+	}
+}
+#endif
+
+// Lemire's fastmod of a hash folded to 32 bits: (hash folded) % divisor,
+// with reciprocal = 2^64 / divisor rounded up
+inline size_t fastmod_index(size_t hash, std::uint32_t divisor, std::uint64_t reciprocal) {
+	std::uint64_t h = hash;
+	std::uint32_t folded = (std::uint32_t)(h ^ (h >> 32));
+#ifdef __SIZEOF_INT128__
+	std::uint64_t low = reciprocal * folded;
+	return (size_t)(((unsigned __int128)low * divisor) >> 64);
+#else
+	(void)reciprocal;
+	return folded % divisor;
+#endif
+}
+
+#ifdef SJTU_BATCH_HASH_AVX2
+// out[i] = fastmod of keys[i], as in batch_fastmod_index() below. The
+// 64 x 32-bit products are assembled from 32 x 32-bit ones: the low half
+// for reciprocal * folded, the high half for low * divisor.
+template<class Key>
+__attribute__((target("avx2")))
+void batch_fastmod_index_avx2(const Key *keys, size_t n, std::uint32_t divisor, std::uint64_t reciprocal,
+                              size_t *out) {
+	const __m256i rec = _mm256_set1_epi64x((long long)reciprocal);
+	const __m256i rec_hi = _mm256_srli_epi64(rec, 32);
+	const __m256i div = _mm256_set1_epi64x((long long)divisor);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256i h;
+		if constexpr (sizeof(Key) == 4) {
+			__m128i k = _mm_loadu_si128((const __m128i *)(keys + i));
+			h = std::is_signed<Key>::value ? _mm256_cvtepi32_epi64(k) : _mm256_cvtepu32_epi64(k);
+		} else {
+			h = _mm256_loadu_si256((const __m256i *)(keys + i));
+		}
+		__m256i folded = _mm256_xor_si256(h, _mm256_srli_epi64(h, 32));
+		__m256i low = _mm256_add_epi64(_mm256_mul_epu32(rec, folded),
+		                               _mm256_slli_epi64(_mm256_mul_epu32(rec_hi, folded), 32));
+		__m256i high = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(low, 32), div),
+		                                _mm256_srli_epi64(_mm256_mul_epu32(low, div), 32));
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_srli_epi64(high, 32));
+	}
+	for (; i < n; ++i) {
+		out[i] = fastmod_index((size_t)keys[i], divisor, reciprocal);
+	}
+}
+#endif
+
+/**
+ * out[i] = Fibonacci-hashing bucket index of keys[i] used as its own
+ * hash value, for a table of 2^(64 - shift) buckets.
+ */
+template<class Key>
+void batch_fibonacci_index(const Key *keys, size_t n, unsigned shift, size_t *out) {
+#ifdef SJTU_BATCH_HASH_AVX2
+	if constexpr (sizeof(Key) == 4 || sizeof(Key) == 8) {
+		if (cpu_has_avx2()) {
+			batch_fibonacci_index_avx2(keys, n, shift, out);
+			return;
+		}
+	}
+#endif
+	for (size_t i = 0; i < n; ++i) {
+		out[i] = (size_t)(((std::uint64_t)(size_t)keys[i] * FIBONACCI_MULTIPLIER) >> shift);
+	}
+}
+
+/**
+ * out[i] = prime_index bucket index of keys[i] used as its own hash
+ * value, for a table of divisor buckets.
+ */
+template<class Key>
+void batch_fastmod_index(const Key *keys, size_t n, std::uint32_t divisor, std::uint64_t reciprocal, size_t *out) {
+#if defined(SJTU_BATCH_HASH_AVX2) && defined(__SIZEOF_INT128__)
+	if constexpr (sizeof(Key) == 4 || sizeof(Key) == 8) {
+		if (cpu_has_avx2()) {
+			batch_fastmod_index_avx2(keys, n, divisor, reciprocal, out);
+			return;
+		}
+	}
+#endif
+	for (size_t i = 0; i < n; ++i) {
+		out[i] = fastmod_index((size_t)keys[i], divisor, reciprocal);
+	}
+}
+
+}
+}
+
+#endif
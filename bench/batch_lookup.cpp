@@ -0,0 +1,64 @@
+// Bulk-load and lookup of linked_hashmap<int, int>, one key at a time
+// versus the batched insert_batch()/find_batch() paths.
+//   usage: bench_batch_lookup [entries]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+typedef sjtu::linked_hashmap<int, int> map_type;
+typedef std::chrono::steady_clock clock_type;
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+	std::vector<map_type::value_type> rows;
+	std::vector<int> keys;
+	rows.reserve(n);
+	keys.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		int k = (int)(next_rand() >> 1);
+		rows.push_back(map_type::value_type(k, (int)i));
+		keys.push_back((int)(next_rand() >> 1) % 2 ? k : -k);
+	}
+
+	clock_type::time_point t0 = clock_type::now();
+	map_type a;
+	for (size_t i = 0; i < n; ++i) a.insert(rows[i]);
+	double insert_one = seconds_since(t0);
+
+	t0 = clock_type::now();
+	map_type b;
+	b.insert_batch(rows.data(), n);
+	double insert_many = seconds_since(t0);
+
+	long long hits = 0;
+	t0 = clock_type::now();
+	for (size_t i = 0; i < n; ++i) hits += a.count(keys[i]);
+	double find_one = seconds_since(t0);
+
+	std::vector<const map_type::value_type *> results(n);
+	long long batch_hits = 0;
+	t0 = clock_type::now();
+	b.find_batch(keys.data(), n, results.data());
+	for (size_t i = 0; i < n; ++i) batch_hits += results[i] != nullptr;
+	double find_many = seconds_since(t0);
+
+	std::printf("entries %zu (sizes %zu / %zu)\n", n, a.size(), b.size());
+	std::printf("insert      %7.1f ns/key   insert_batch %7.1f ns/key\n", insert_one * 1e9 / n, insert_many * 1e9 / n);
+	std::printf("count       %7.1f ns/key   find_batch   %7.1f ns/key   (hits %lld / %lld)\n",
+	            find_one * 1e9 / n, find_many * 1e9 / n, hits, batch_hits);
+	return 0;
+}
@@ -0,0 +1,187 @@
+// hit ratio and throughput of the cache.hpp policies, and of a FIFO kept
+// in a plain linked_hashmap, on Zipf-distributed key traces (ranks
+// scrambled so popular keys are not neighbours) plus one trace where a
+// sequential scan interrupts the Zipf traffic. Every miss is followed by
+// a put, as a read-through cache would do. "lru+a" is lru_cache with
+// TinyLFU admission enabled.
+// Last, the same replay split over several threads, clock_cache against
+// lru_cache behind a mutex.
+//   usage: bench_cache_policies [keys] [requests]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "cache.hpp"
+#include "linked_hashmap.hpp"
+
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+// evicts in insertion order; hits do not reorder
+class fifo_cache {
+	sjtu::linked_hashmap<long long, long long> entries;
+	size_t max_size;
+	sjtu::cache_stats counters;
+
+public:
+	explicit fifo_cache(size_t capacity) : max_size(capacity), counters() {
+		entries.reserve(capacity);
+	}
+
+	long long * get(long long key) {
+		long long *value = entries.find_ptr(key);
+		++(value ? counters.hits : counters.misses);
+		return value;
+	}
+
+	void put(long long key, long long value) {
+		if (entries.size() >= max_size) {
+			entries.erase(entries.begin());
+			++counters.evictions;
+		}
+		entries[key] = value;
+	}
+
+	sjtu::cache_stats stats() const {
+		return counters;
+	}
+};
+
+class admitting_lru_cache : public sjtu::lru_cache<long long, long long> {
+public:
+	explicit admitting_lru_cache(size_t capacity) : lru_cache(capacity) {
+		enable_admission();
+	}
+};
+
+static std::vector<long long> zipf_trace(int keys, int requests, double alpha, unsigned long long seed) {
+	std::vector<double> cdf(keys);
+	double sum = 0;
+	for (int i = 0; i < keys; ++i) cdf[i] = sum += 1 / std::pow(i + 1.0, alpha);
+	std::vector<long long> trace(requests);
+	unsigned long long x = seed;
+	for (int i = 0; i < requests; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		double u = (x >> 11) * (1.0 / 9007199254740992.0) * sum;
+		long long rank = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+		trace[i] = (rank * 0x9e3779b97f4a7c15ll) >> 8;
+	}
+	return trace;
+}
+
+template<class Cache>
+static bool lookup(Cache &cache, long long key, long long &value) {
+	long long *found = cache.get(key);
+	if (found) value = *found;
+	return found;
+}
+
+static bool lookup(sjtu::clock_cache<long long, long long> &cache, long long key, long long &value) {
+	return cache.get(key, value);
+}
+
+// an lru_cache that several threads can share
+class locked_lru_cache {
+	sjtu::lru_cache<long long, long long> cache;
+	std::mutex lock;
+
+public:
+	explicit locked_lru_cache(size_t capacity) : cache(capacity) {}
+
+	bool get(long long key, long long &value) {
+		std::lock_guard<std::mutex> guard(lock);
+		long long *found = cache.get(key);
+		if (found) value = *found;
+		return found;
+	}
+
+	void put(long long key, long long value) {
+		std::lock_guard<std::mutex> guard(lock);
+		cache.put(key, value);
+	}
+
+	sjtu::cache_stats stats() {
+		std::lock_guard<std::mutex> guard(lock);
+		return cache.stats();
+	}
+};
+
+template<class Cache>
+static void run_threads(const char *name, size_t capacity, const std::vector<long long> &trace, int threads) {
+	Cache cache(capacity);
+	std::vector<std::thread> workers;
+	clock_type::time_point t0 = clock_type::now();
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&cache, &trace, t, threads] {
+			long long value;
+			for (size_t i = t; i < trace.size(); i += threads) {
+				if (!cache.get(trace[i], value)) cache.put(trace[i], trace[i]);
+			}
+		});
+	}
+	for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+	double time = seconds_since(t0);
+	std::printf("  %-9s %d threads  hit ratio %6.2f%%  %6.2f Mops/s\n", name, threads,
+	            100 * cache.stats().hit_ratio(), trace.size() / time / 1e6);
+}
+
+template<class Cache>
+static void run(const char *name, size_t capacity, const std::vector<long long> &trace) {
+	Cache cache(capacity);
+	long long sum = 0;
+	clock_type::time_point t0 = clock_type::now();
+	for (size_t i = 0; i < trace.size(); ++i) {
+		long long value;
+		if (lookup(cache, trace[i], value)) sum += value;
+		else cache.put(trace[i], trace[i]);
+	}
+	double time = seconds_since(t0);
+	std::printf("  %-5s hit ratio %6.2f%%  %6.2f Mops/s  (%lld)\n", name, 100 * cache.stats().hit_ratio(),
+	            trace.size() / time / 1e6, sum & 0xff);
+}
+
+static void compare(const char *trace_name, size_t capacity, const std::vector<long long> &trace) {
+	std::printf("%s, capacity %zu\n", trace_name, capacity);
+	run<fifo_cache>("fifo", capacity, trace);
+	run<sjtu::lru_cache<long long, long long> >("lru", capacity, trace);
+	run<admitting_lru_cache>("lru+a", capacity, trace);
+	run<sjtu::lfu_cache<long long, long long> >("lfu", capacity, trace);
+	run<sjtu::two_queue_cache<long long, long long> >("2q", capacity, trace);
+	run<sjtu::arc_cache<long long, long long> >("arc", capacity, trace);
+	run<sjtu::clock_cache<long long, long long> >("clock", capacity, trace);
+}
+
+int main(int argc, char **argv) {
+	int keys = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	int requests = argc > 2 ? std::atoi(argv[2]) : 4000000;
+	const double alphas[] = {0.8, 0.99, 1.2};
+	char name[64];
+	for (double alpha : alphas) {
+		std::vector<long long> trace = zipf_trace(keys, requests, alpha, 88172645463325252ull);
+		std::snprintf(name, sizeof(name), "zipf %.2f", alpha);
+		compare(name, keys / 100, trace);
+		compare(name, keys / 10, trace);
+	}
+
+	// a scan of every key through the middle of the Zipf traffic
+	std::vector<long long> trace = zipf_trace(keys, requests, 0.99, 2463534242ull);
+	std::vector<long long> scanned(trace.begin(), trace.begin() + requests / 2);
+	for (int i = 0; i < keys; ++i) scanned.push_back(-1 - i);
+	scanned.insert(scanned.end(), trace.begin() + requests / 2, trace.end());
+	compare("zipf 0.99 + scan", keys / 100, scanned);
+
+	std::printf("zipf 0.99, capacity %d, shared by threads\n", keys / 100);
+	const int thread_counts[] = {1, 2, 4};
+	for (int threads : thread_counts) {
+		run_threads<locked_lru_cache>("lru+mutex", keys / 100, trace, threads);
+		run_threads<sjtu::clock_cache<long long, long long> >("clock", keys / 100, trace, threads);
+	}
+	return 0;
+}
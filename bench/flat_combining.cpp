@@ -0,0 +1,132 @@
+// a shared map under write-heavy traffic from 1 to 64 threads: one mutex
+// around linked_hashmap, 64 mutex-guarded shards, and flat_combining_map.
+// Each thread runs 50% assign, 25% find, 25% erase over a common key range;
+// the total work is the same at every thread count.
+//   usage: bench_flat_combining [operations] [keys]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "flat_combining.hpp"
+#include "linked_hashmap.hpp"
+
+typedef sjtu::linked_hashmap<long long, long long> map_type;
+typedef std::chrono::steady_clock clock_type;
+
+static const size_t SHARDS = 64;
+
+struct op {
+	int kind;  // 0, 1 assign, 2 find, 3 erase
+	long long key;
+};
+
+class mutex_map {
+	map_type map;
+	std::mutex lock;
+
+public:
+	explicit mutex_map(size_t) {}
+
+	void apply(size_t, const op &o, long long &sink) {
+		std::lock_guard<std::mutex> guard(lock);
+		if (o.kind < 2) {
+			map[o.key] = o.key;
+		} else if (o.kind == 2) {
+			map_type::iterator it = map.find(o.key);
+			if (it != map.end()) sink += it->second;
+		} else {
+			map.compute_if_present(o.key, [](const long long &, long long &) { return false; });
+		}
+	}
+};
+
+class sharded_map {
+	struct shard {
+		map_type map;
+		std::mutex lock;
+	};
+	std::vector<shard> shards;
+
+public:
+	explicit sharded_map(size_t) : shards(SHARDS) {}
+
+	void apply(size_t, const op &o, long long &sink) {
+		shard &s = shards[std::hash<long long>()(o.key) * 0x9e3779b97f4a7c15ull >> 58];
+		std::lock_guard<std::mutex> guard(s.lock);
+		if (o.kind < 2) {
+			s.map[o.key] = o.key;
+		} else if (o.kind == 2) {
+			map_type::iterator it = s.map.find(o.key);
+			if (it != s.map.end()) sink += it->second;
+		} else {
+			s.map.compute_if_present(o.key, [](const long long &, long long &) { return false; });
+		}
+	}
+};
+
+class combining_map {
+	sjtu::flat_combining_map<long long, long long> map;
+
+public:
+	explicit combining_map(size_t threads) : map(threads) {}
+
+	void apply(size_t thread, const op &o, long long &sink) {
+		if (o.kind < 2) {
+			map.assign(thread, o.key, o.key);
+		} else if (o.kind == 2) {
+			long long value;
+			if (map.find(thread, o.key, value)) sink += value;
+		} else {
+			map.erase(thread, o.key);
+		}
+	}
+
+	double batch_size() {
+		sjtu::flat_combining_map<long long, long long>::combining_stats s = map.stats();
+		return s.batches ? (double)s.operations / s.batches : 0;
+	}
+};
+
+template<class Map>
+static double run(Map &map, const std::vector<op> &ops, size_t threads) {
+	std::vector<std::thread> workers;
+	std::vector<long long> sinks(threads);
+	clock_type::time_point t0 = clock_type::now();
+	for (size_t t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t] {
+			size_t begin = ops.size() * t / threads, end = ops.size() * (t + 1) / threads;
+			long long sink = 0;
+			for (size_t i = begin; i < end; ++i) map.apply(t, ops[i], sink);
+			sinks[t] = sink;
+		});
+	}
+	for (size_t t = 0; t < threads; ++t) workers[t].join();
+	return std::chrono::duration<double>(clock_type::now() - t0).count() * 1e9 / ops.size();
+}
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? (size_t)std::atol(argv[1]) : 2000000;
+	long long keys = argc > 2 ? std::atoll(argv[2]) : 1 << 20;
+	std::vector<op> ops(n);
+	unsigned long long x = 88172645463325252ull;
+	for (size_t i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		ops[i].kind = (int)(x & 3);
+		ops[i].key = (long long)((x >> 2) % (unsigned long long)keys);
+	}
+	std::printf("%zu operations over %lld keys, %u hardware threads\n", n, keys,
+	            std::thread::hardware_concurrency());
+	for (size_t threads = 1; threads <= 64; threads *= 2) {
+		mutex_map plain(threads);
+		sharded_map sharded(threads);
+		combining_map combining(threads);
+		double a = run(plain, ops, threads);
+		double b = run(sharded, ops, threads);
+		double c = run(combining, ops, threads);
+		std::printf("threads %2zu  mutex %7.1f ns  sharded %7.1f ns  combining %7.1f ns  (batch %.1f)\n",
+		            threads, a, b, c, combining.batch_size());
+	}
+	return 0;
+}
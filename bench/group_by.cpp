@@ -0,0 +1,87 @@
+// group-by aggregation (count, sum, min, max per key) of generated rows
+// over few and over many distinct keys:
+//   two probes   - find_ptr(), then insert() of a new group on a miss
+//   group_by     - one try_emplace() per row
+//   add_parallel - group_by over a thread_pool
+//   usage: bench_group_by [rows]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "group_by.hpp"
+#include "linked_hashmap.hpp"
+#include "thread_pool.hpp"
+
+struct row {
+	long long key;
+	long long value;
+};
+
+typedef sjtu::basic_aggregate<long long> aggregate;
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+static long long key_of(const row &r) {
+	return r.key;
+}
+
+static long long value_of(const row &r) {
+	return r.value;
+}
+
+static long long checksum(const sjtu::linked_hashmap<long long, aggregate> &groups) {
+	long long sum = 0, position = 0;
+	for (auto it = groups.cbegin(); it != groups.cend(); ++it) {
+		sum += ++position * (it->first ^ it->second.sum ^ it->second.min ^ (long long)it->second.count);
+	}
+	return sum;
+}
+
+static void run(const std::vector<row> &rows, long long keys) {
+	size_t n = rows.size();
+	std::printf("%zu rows, %lld keys\n", n, keys);
+
+	clock_type::time_point t0 = clock_type::now();
+	sjtu::linked_hashmap<long long, aggregate> naive;
+	for (size_t i = 0; i < n; ++i) {
+		aggregate *group = naive.find_ptr(rows[i].key);
+		if (!group) group = &naive.insert(sjtu::linked_hashmap<long long, aggregate>::value_type(rows[i].key, aggregate())).first->second;
+		group->add(rows[i].value);
+	}
+	std::printf("  two probes        %6.1f ns/row  (%zu groups, %llx)\n", seconds_since(t0) * 1e9 / n,
+	            naive.size(), (unsigned long long)checksum(naive));
+
+	t0 = clock_type::now();
+	sjtu::group_by<long long, long long> single;
+	single.add(rows.begin(), rows.end(), key_of, value_of);
+	std::printf("  group_by          %6.1f ns/row  (%zu groups, %llx)\n", seconds_since(t0) * 1e9 / n,
+	            single.size(), (unsigned long long)checksum(single.groups()));
+
+	const size_t thread_counts[] = {1, 2, 4};
+	for (size_t threads : thread_counts) {
+		sjtu::thread_pool pool(threads);
+		t0 = clock_type::now();
+		sjtu::group_by<long long, long long> parallel;
+		parallel.add_parallel(rows.begin(), rows.end(), key_of, value_of, pool);
+		std::printf("  add_parallel x%-3zu %6.1f ns/row  (%zu groups, %llx)\n", threads, seconds_since(t0) * 1e9 / n,
+		            parallel.size(), (unsigned long long)checksum(parallel.groups()));
+	}
+}
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000;
+	const long long key_counts[] = {1000, 1000000};
+	std::vector<row> rows(n);
+	for (long long keys : key_counts) {
+		unsigned long long x = 88172645463325252ull;
+		for (size_t i = 0; i < n; ++i) {
+			x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+			rows[i] = row{(long long)(x % (unsigned long long)keys) * 7919, (long long)(x >> 40)};
+		}
+		run(rows, keys);
+	}
+	return 0;
+}
@@ -0,0 +1,105 @@
+// hash_join against a naive join: a linked_hashmap<key, std::vector<row> >
+// built with operator[] and probed with one find() per row. The build
+// side has duplicate keys (about 1.6 rows per key); about half of the
+// probe rows match. The probe rows are generated in chunks, so only the
+// build side has to fit in memory.
+//   usage: bench_hash_join [build rows] [probe rows]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "hash_join.hpp"
+#include "linked_hashmap.hpp"
+
+struct row {
+	long long key;
+	long long payload;
+};
+
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+static const size_t CHUNK = 1 << 20;
+
+static unsigned long long state;
+
+static long long next_key(long long range) {
+	state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+	return (long long)(state % (unsigned long long)range);
+}
+
+static std::vector<row> build_rows(size_t n) {
+	std::vector<row> rows(n);
+	state = 88172645463325252ull;
+	for (size_t i = 0; i < n; ++i) rows[i] = row{next_key((long long)n), (long long)i};
+	return rows;
+}
+
+// fills chunk with the next probe rows, keys in [0, 2 * build)
+static void probe_rows(std::vector<row> &chunk, size_t n, size_t build) {
+	chunk.resize(n);
+	for (size_t i = 0; i < n; ++i) chunk[i] = row{next_key(2 * (long long)build), (long long)i};
+}
+
+static void naive(const std::vector<row> &build, size_t probes) {
+	clock_type::time_point t0 = clock_type::now();
+	sjtu::linked_hashmap<long long, std::vector<row> > table;
+	for (size_t i = 0; i < build.size(); ++i) table[build[i].key].push_back(build[i]);
+	double build_time = seconds_since(t0);
+
+	state = 2463534242ull;
+	std::vector<row> chunk;
+	size_t matches = 0;
+	long long checksum = 0;
+	double probe_time = 0;
+	for (size_t done = 0; done < probes; done += CHUNK) {
+		probe_rows(chunk, probes - done < CHUNK ? probes - done : CHUNK, build.size());
+		t0 = clock_type::now();
+		for (size_t i = 0; i < chunk.size(); ++i) {
+			const std::vector<row> *rows = table.find_ptr(chunk[i].key);
+			if (!rows) continue;
+			for (size_t j = 0; j < rows->size(); ++j) {
+				checksum += chunk[i].payload ^ (*rows)[j].payload;
+				++matches;
+			}
+		}
+		probe_time += seconds_since(t0);
+	}
+	std::printf("naive      build %6.1f ns/row  probe %6.1f ns/row  (matches %zu, checksum %lld)\n",
+	            build_time * 1e9 / build.size(), probe_time * 1e9 / probes, matches, checksum);
+}
+
+static void joined(const std::vector<row> &build, size_t probes) {
+	clock_type::time_point t0 = clock_type::now();
+	sjtu::hash_join<long long, row> join;
+	join.build(build.begin(), build.end(), [](const row &r) { return r.key; });
+	double build_time = seconds_since(t0);
+
+	state = 2463534242ull;
+	std::vector<row> chunk;
+	size_t matches = 0;
+	long long checksum = 0;
+	double probe_time = 0;
+	for (size_t done = 0; done < probes; done += CHUNK) {
+		probe_rows(chunk, probes - done < CHUNK ? probes - done : CHUNK, build.size());
+		t0 = clock_type::now();
+		matches += join.probe(chunk.begin(), chunk.end(), [](const row &r) { return r.key; },
+		                      [&checksum](const row &p, const row &b) { checksum += p.payload ^ b.payload; });
+		probe_time += seconds_since(t0);
+	}
+	std::printf("hash_join  build %6.1f ns/row  probe %6.1f ns/row  (matches %zu, checksum %lld)\n",
+	            build_time * 1e9 / build.size(), probe_time * 1e9 / probes, matches, checksum);
+}
+
+int main(int argc, char **argv) {
+	size_t build = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+	size_t probes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000000;
+	std::vector<row> rows = build_rows(build);
+	std::printf("build %zu rows, probe %zu rows\n", build, probes);
+	naive(rows, probes);
+	joined(rows, probes);
+	return 0;
+}
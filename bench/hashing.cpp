@@ -0,0 +1,89 @@
+// std::hash versus sjtu::fast_hash on key sets shaped like those of data/
+// (dense and random small integers, short strings) plus strided integers
+// and long strings.
+// For each hasher: raw throughput, insert + find time in a linked_hashmap
+// with pow2_index, and the quality of the low bits over the distinct keys
+// (longest chain and empty buckets when a table takes 'hash % 2^k'
+// directly; a uniform hash leaves about 37% of the buckets empty).
+//   usage: bench_hashing [keys]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "fast_hash.hpp"
+#include "linked_hashmap.hpp"
+
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+template<class Key, class Hash>
+static void run(const char *set, const char *name, const std::vector<Key> &keys) {
+	Hash hash;
+	size_t n = keys.size();
+
+	const int rounds = 20;
+	size_t mix = 0;
+	clock_type::time_point t0 = clock_type::now();
+	for (int r = 0; r < rounds; ++r) {
+		for (size_t i = 0; i < n; ++i) mix += hash(keys[i]);
+	}
+	double hashing = seconds_since(t0) * 1e9 / rounds / n;
+
+	sjtu::linked_hashmap<Key, int, Hash, std::equal_to<Key>, sjtu::pow2_index> map;
+	t0 = clock_type::now();
+	for (size_t i = 0; i < n; ++i) map[keys[i]] = (int)i;
+	size_t found = 0;
+	for (size_t i = 0; i < n; ++i) found += map.contains(keys[i]);
+	double use = seconds_since(t0) * 1e9 / n;
+
+	// chains over the distinct keys
+	size_t buckets = 1;
+	while (buckets < map.size()) buckets <<= 1;
+	std::vector<unsigned> chain(buckets, 0);
+	unsigned longest = 0;
+	for (auto it = map.cbegin(); it != map.cend(); ++it) {
+		unsigned c = ++chain[hash(it->first) & (buckets - 1)];
+		if (c > longest) longest = c;
+	}
+	size_t empty = 0;
+	for (size_t i = 0; i < buckets; ++i) empty += chain[i] == 0;
+
+	std::printf("%-14s %-10s %6.2f ns/hash  longest chain %4u  empty %5.1f%%  map %7.1f ns/key  (%zu %zx)\n",
+	            set, name, hashing, longest, 100.0 * empty / buckets, use, found, mix & 0xff);
+}
+
+template<class Key>
+static void compare(const char *set, const std::vector<Key> &keys) {
+	run<Key, std::hash<Key> >(set, "std::hash", keys);
+	run<Key, sjtu::fast_hash<Key> >(set, "fast_hash", keys);
+}
+
+int main(int argc, char **argv) {
+	int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	unsigned int x = 2463534242u;
+	std::vector<int> dense(n), random_small(n), random(n), strided(n);
+	for (int i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+		dense[i] = i;
+		random_small[i] = (int)(x % 10000);
+		random[i] = (int)(x >> 1);
+		strided[i] = i * 4096;
+	}
+	std::vector<std::string> short_strings(n), long_strings(n);
+	for (int i = 0; i < n; ++i) {
+		short_strings[i] = std::to_string(i);
+		long_strings[i] = "/var/lib/service/objects/by-id/0000/" + std::to_string(i) + "/payload.bin";
+	}
+
+	compare("dense int", dense);
+	compare("random % 10000", random_small);
+	compare("random int", random);
+	compare("stride 4096", strided);
+	compare("short string", short_strings);
+	compare("long string", long_strings);
+	return 0;
+}
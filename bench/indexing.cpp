@@ -0,0 +1,116 @@
+// Compares the bucket indexing policies on workloads shaped like the
+// data/ tests plus a random and a strided (poor hash) key set.
+//   usage: bench_indexing [scale]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+typedef std::chrono::steady_clock clock_type;
+
+// the original 'hash % buckets' reduction over power-of-two bucket counts
+class modulo_index {
+private:
+	size_t buckets;
+
+public:
+	modulo_index() : buckets(1) {}
+	static size_t round_up(size_t n) { return sjtu::pow2_index::round_up(n); }
+	static size_t grow(size_t n) { return n * 2; }
+	void reset(size_t n) { buckets = n; }
+	size_t operator()(size_t hash) const { return hash % buckets; }
+	template<class Int>
+	void index_integers(const Int *keys, size_t n, size_t *out) const {
+		for (size_t i = 0; i < n; ++i) out[i] = (size_t)keys[i] % buckets;
+	}
+};
+
+struct identity_hash {
+	size_t operator()(int x) const { return (unsigned)x; }
+};
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+// data/testsix: count() misses followed by operator[] inserts, then a full
+// iteration summing the values, repeated on a cleared map
+template<class Policy>
+double workload_six(int rounds, long long &sum) {
+	sjtu::linked_hashmap<int, int, identity_hash, std::equal_to<int>, Policy> map;
+	int cur = 3;
+	clock_type::time_point t0 = clock_type::now();
+	for (int r = 0; r < rounds; ++r) {
+		for (int j = 0; j < 10000; ++j) {
+			cur = 1ll * cur * 233 % 23333;
+			if (!map.count(cur)) {
+				cur = 1ll * cur * 233 % 23333;
+				map[cur] = cur;
+			}
+		}
+		for (auto it = map.begin(); it != map.end(); ++it) sum += it->second;
+		map.clear();
+	}
+	return seconds_since(t0);
+}
+
+// data/testfour: random inserts, lookups and erases over a small key range
+template<class Policy>
+double workload_four(int ops, long long &sum) {
+	sjtu::linked_hashmap<int, int, identity_hash, std::equal_to<int>, Policy> map;
+	long long now = 1;
+	clock_type::time_point t0 = clock_type::now();
+	for (int i = 0; i < ops; ++i) {
+		now = (now * 13131 + 5353) % 1000000007;
+		int key = (int)(now % 10000);
+		switch (i % 3) {
+		case 0: map[key] = i; break;
+		case 1: sum += map.count(key); break;
+		default: {
+			auto it = map.find(key);
+			if (it != map.end()) map.erase(it);
+		}
+		}
+	}
+	return seconds_since(t0);
+}
+
+// n keys inserted then looked up; stride 1 gives random keys, which
+// spread under any reduction, stride 256 leaves the low 8 bits of every
+// hash zero
+template<class Policy>
+double workload_keys(int n, long long stride, long long &sum) {
+	sjtu::linked_hashmap<long long, int, std::hash<long long>, std::equal_to<long long>, Policy> map;
+	unsigned long long x = 88172645463325252ull;
+	std::vector<long long> keys(n);
+	for (int i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		keys[i] = stride == 1 ? (long long)(x >> 1) : (long long)i * stride;
+	}
+	clock_type::time_point t0 = clock_type::now();
+	for (int i = 0; i < n; ++i) map[keys[i]] = i;
+	for (int r = 0; r < 4; ++r) {
+		for (int i = 0; i < n; ++i) sum += map.count(keys[i] + r);
+	}
+	return seconds_since(t0);
+}
+
+template<class Policy>
+void run(const char *name, int scale) {
+	long long sum = 0;
+	double six = workload_six<Policy>(100 * scale, sum);
+	double four = workload_four<Policy>(1000000 * scale, sum);
+	double random = workload_keys<Policy>(500000 * scale, 1, sum);
+	double strided = workload_keys<Policy>(50000 * scale, 256, sum);
+	std::printf("%-14s testsix %7.3fs  testfour %7.3fs  random %7.3fs  strided %7.3fs  (%lld)\n",
+	            name, six, four, random, strided, sum);
+}
+
+int main(int argc, char **argv) {
+	int scale = argc > 1 ? std::atoi(argv[1]) : 1;
+	run<modulo_index>("modulo", scale);
+	run<sjtu::pow2_index>("pow2_index", scale);
+	run<sjtu::prime_index>("prime_index", scale);
+	return 0;
+}
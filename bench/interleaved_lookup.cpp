@@ -0,0 +1,61 @@
+// Compares plain find() against coroutine-interleaved lookups on a map
+// much larger than the last-level cache.
+//   usage: bench_interleaved_lookup [entries] [probes]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "linked_hashmap.hpp"
+#include "interleaved_lookup.hpp"
+
+typedef sjtu::linked_hashmap<long long, long long> map_type;
+
+static unsigned long long state = 88172645463325252ull;
+static unsigned long long next_rand() {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+int main(int argc, char **argv) {
+	size_t entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1u << 22);
+	size_t probes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : (1u << 22);
+
+	map_type map;
+	for (size_t i = 0; i < entries; ++i) {
+		map[(long long)(next_rand() >> 1)] = (long long)i;
+	}
+	// half hits, half (almost surely) misses
+	std::vector<long long> keys(probes);
+	std::vector<long long> present;
+	present.reserve(entries);
+	for (map_type::iterator it = map.begin(); it != map.end(); ++it) present.push_back(it->first);
+	for (size_t i = 0; i < probes; ++i) {
+		keys[i] = (i & 1) ? (long long)(next_rand() >> 1) : present[next_rand() % present.size()];
+	}
+
+	typedef std::chrono::steady_clock clock;
+	long long checksum = 0;
+	clock::time_point t0 = clock::now();
+	for (size_t i = 0; i < probes; ++i) {
+		map_type::iterator it = map.find(keys[i]);
+		if (it != map.end()) checksum += it->second;
+	}
+	double plain = std::chrono::duration<double>(clock::now() - t0).count();
+	std::printf("find()                 %8.1f ns/lookup  (checksum %lld)\n", plain * 1e9 / probes, checksum);
+
+	std::vector<const map_type::value_type *> results(probes);
+	for (size_t group : {1, 4, 8, 16, 32, 64}) {
+		sjtu::interleaved_lookup<map_type> lookup(map, group);
+		checksum = 0;
+		t0 = clock::now();
+		lookup.find(keys.data(), probes, results.data());
+		for (size_t i = 0; i < probes; ++i) {
+			if (results[i]) checksum += results[i]->second;
+		}
+		double t = std::chrono::duration<double>(clock::now() - t0).count();
+		std::printf("interleaved group=%-4zu %8.1f ns/lookup  (checksum %lld)\n", group, t * 1e9 / probes, checksum);
+	}
+	return 0;
+}
@@ -0,0 +1,57 @@
+// count() over mostly missing keys, as in data/testsix, with and without
+// the miss filter, on a map small enough for the cache and on one much
+// larger than it; plus the insert cost the filter adds.
+//   usage: bench_miss_filter [entries] [lookups]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+typedef sjtu::linked_hashmap<long long, int> map_type;
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+static void run(int n, int lookups, int miss_percent) {
+	std::vector<long long> keys(n), probes(lookups);
+	unsigned long long x = 88172645463325252ull;
+	for (int i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		keys[i] = (long long)(x >> 2) * 2;  // even keys are present
+	}
+	for (int i = 0; i < lookups; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		probes[i] = (int)(x % 100) < miss_percent ? (long long)(x >> 2) * 2 + 1 : keys[x % n];
+	}
+
+	for (int filtered = 0; filtered < 2; ++filtered) {
+		map_type map;
+		if (filtered) map.enable_miss_filter();
+		clock_type::time_point t0 = clock_type::now();
+		for (int i = 0; i < n; ++i) map[keys[i]] = i;
+		double insert = seconds_since(t0);
+
+		size_t hits = 0;
+		t0 = clock_type::now();
+		for (int i = 0; i < lookups; ++i) hits += map.count(probes[i]);
+		double count = seconds_since(t0);
+
+		map_type::miss_filter_stats stats = map.filter_stats();
+		std::printf("entries %8d  misses %3d%%  %-9s insert %6.1f ns  count %6.1f ns  (hits %zu, fp rate %.4f%%)\n",
+		            n, miss_percent, filtered ? "filter" : "no filter", insert * 1e9 / n,
+		            count * 1e9 / lookups, hits, 100 * stats.false_positive_rate);
+	}
+}
+
+int main(int argc, char **argv) {
+	int n = argc > 1 ? std::atoi(argv[1]) : 4000000;
+	int lookups = argc > 2 ? std::atoi(argv[2]) : 4000000;
+	run(10000, lookups, 90);
+	run(n, lookups, 50);
+	run(n, lookups, 90);
+	run(n, lookups, 100);
+	return 0;
+}
@@ -0,0 +1,70 @@
+// Lookups with a given share of misses: at() inside try/catch (as in
+// data/testfour) versus the non-throwing find_ptr(), get_or() and
+// contains().
+//   usage: bench_miss_lookup [entries] [lookups]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+typedef sjtu::linked_hashmap<int, int> map_type;
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+	int n = argc > 1 ? std::atoi(argv[1]) : 100000;
+	int lookups = argc > 2 ? std::atoi(argv[2]) : 1000000;
+	map_type map;
+	// even keys are present, odd keys miss
+	for (int i = 0; i < n; ++i) map[2 * i] = i;
+
+	const int miss_percent[] = {0, 10, 50, 90, 100};
+	for (size_t m = 0; m < sizeof(miss_percent) / sizeof(miss_percent[0]); ++m) {
+		std::vector<int> keys(lookups);
+		unsigned int x = 2463534242u;
+		for (int i = 0; i < lookups; ++i) {
+			x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+			int key = 2 * (int)(x % (unsigned)n);
+			keys[i] = (int)(x >> 8) % 100 < miss_percent[m] ? key + 1 : key;
+		}
+
+		long long sum = 0;
+		clock_type::time_point t0 = clock_type::now();
+		for (int i = 0; i < lookups; ++i) {
+			try {
+				sum += map.at(keys[i]);
+			} catch (...) {
+				sum -= 1;
+			}
+		}
+		double at = seconds_since(t0);
+
+		long long sum2 = 0;
+		t0 = clock_type::now();
+		for (int i = 0; i < lookups; ++i) {
+			const int *value = map.find_ptr(keys[i]);
+			sum2 += value ? *value : -1;
+		}
+		double find_ptr = seconds_since(t0);
+
+		long long sum3 = 0;
+		t0 = clock_type::now();
+		for (int i = 0; i < lookups; ++i) sum3 += map.get_or(keys[i], -1);
+		double get_or = seconds_since(t0);
+
+		size_t hits = 0;
+		t0 = clock_type::now();
+		for (int i = 0; i < lookups; ++i) hits += map.contains(keys[i]);
+		double contains = seconds_since(t0);
+
+		std::printf("misses %3d%%  at+catch %8.1f  find_ptr %6.1f  get_or %6.1f  contains %6.1f ns/lookup"
+		            "  (sums %lld %lld %lld, hits %zu)\n", miss_percent[m],
+		            at * 1e9 / lookups, find_ptr * 1e9 / lookups, get_or * 1e9 / lookups,
+		            contains * 1e9 / lookups, sum, sum2, sum3, hits);
+	}
+	return 0;
+}
@@ -0,0 +1,41 @@
+// Time of a single rehash of a large map on 1 to 32 threads. Run it on a
+// multi-core machine: with a single hardware thread the extra threads only
+// add the second pass and contention, so the numbers show overhead, not
+// speedup.
+//   usage: bench_parallel_rehash [entries]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "linked_hashmap.hpp"
+
+typedef sjtu::linked_hashmap<long long, long long> map_type;
+typedef std::chrono::steady_clock clock_type;
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8000000;
+	map_type map;
+	unsigned long long x = 88172645463325252ull;
+	for (size_t i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		map[(long long)(x >> 1)] = (long long)i;
+	}
+	size_t small = map.bucket_count();
+	size_t large = small * 3;
+
+	std::printf("entries %zu, hardware threads %u\n", map.size(), std::thread::hardware_concurrency());
+	for (size_t threads = 1; threads <= 32; threads *= 2) {
+		sjtu::thread_pool pool(threads);
+		map.set_rehash_pool(&pool);
+		double best = 1e30;
+		for (int rep = 0; rep < 3; ++rep) {
+			clock_type::time_point t0 = clock_type::now();
+			map.rehash(large);
+			double grow = std::chrono::duration<double>(clock_type::now() - t0).count();
+			map.rehash(small);
+			if (grow < best) best = grow;
+		}
+		std::printf("threads %2zu  rehash %8.1f ms\n", threads, best * 1e3);
+	}
+	map.set_rehash_pool(nullptr);
+	return 0;
+}
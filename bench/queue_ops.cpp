@@ -0,0 +1,61 @@
+// linked_hashmap as a deduplicating queue: a sliding window of string
+// keys (push at the back, drop the eldest), dequeued one at a time with
+// erase(find(key)) - which hashes the key again - with erase(begin())
+// and with pop_front(), and in batches with trim_front().
+//   usage: bench_queue_ops [window] [pushes]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+typedef sjtu::linked_hashmap<std::string, int> map_type;
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+enum dequeue { BY_KEY, BY_ITERATOR, POP_FRONT, TRIM_FRONT };
+
+static void run(const char *name, dequeue how, size_t window, const std::vector<std::string> &keys) {
+	map_type map;
+	const size_t batch = window / 4;
+	clock_type::time_point t0 = clock_type::now();
+	for (size_t i = 0; i < keys.size(); ++i) {
+		map[keys[i]] = (int)i;
+		if (how == TRIM_FRONT) {
+			if (map.size() >= window + batch) map.trim_front(batch);
+			continue;
+		}
+		if (map.size() <= window) continue;
+		if (how == BY_KEY) {
+			std::string eldest = map.front().first;
+			map.erase(map.find(eldest));
+		} else if (how == BY_ITERATOR) {
+			map.erase(map.begin());
+		} else {
+			map.pop_front();
+		}
+	}
+	double time = seconds_since(t0);
+	std::printf("window %8zu  %-18s %6.1f ns/push  (size %zu)\n", window, name, time * 1e9 / keys.size(), map.size());
+}
+
+int main(int argc, char **argv) {
+	size_t window = argc > 1 ? std::atoi(argv[1]) : 100000;
+	size_t pushes = argc > 2 ? std::atoi(argv[2]) : 4000000;
+	std::vector<std::string> keys(pushes);
+	for (size_t i = 0; i < pushes; ++i) {
+		keys[i] = "/queue/jobs/" + std::to_string(i * 2654435761u % 1000000007u) + "/payload";
+	}
+	const size_t windows[] = {1000, window};
+	for (size_t w : windows) {
+		run("erase(find(key))", BY_KEY, w, keys);
+		run("erase(begin())", BY_ITERATOR, w, keys);
+		run("pop_front()", POP_FRONT, w, keys);
+		run("trim_front(w / 4)", TRIM_FRONT, w, keys);
+	}
+	return 0;
+}
@@ -0,0 +1,61 @@
+// Lookups in a map with 8-byte keys and 256-byte values: linked_hashmap
+// against the split key/value layout of split_linked_hashmap.
+//   usage: bench_split_layout [entries]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "linked_hashmap.hpp"
+#include "split_linked_hashmap.hpp"
+
+struct blob {
+	long long words[32];
+	blob() : words() {}
+	explicit blob(long long x) : words() { words[0] = x; }
+};
+
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+template<class Map>
+void run(const char *name, const std::vector<long long> &keys, const std::vector<long long> &probes) {
+	Map map;
+	for (size_t i = 0; i < keys.size(); ++i) map[keys[i]] = blob(keys[i]);
+
+	clock_type::time_point t0 = clock_type::now();
+	size_t hits = 0;
+	for (size_t i = 0; i < probes.size(); ++i) hits += map.count(probes[i]);
+	double count = seconds_since(t0);
+
+	t0 = clock_type::now();
+	long long sum = 0;
+	for (size_t i = 0; i < probes.size(); ++i) {
+		typename Map::iterator it = map.find(probes[i]);
+		if (it != map.end()) sum += it->second.words[0];
+	}
+	double find = seconds_since(t0);
+
+	std::printf("%-22s count %7.1f ns  find+value %7.1f ns  (hits %zu, sum %lld)\n",
+	            name, count * 1e9 / probes.size(), find * 1e9 / probes.size(), hits, sum);
+}
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+	unsigned long long x = 88172645463325252ull;
+	std::vector<long long> keys(n), probes(4 * n);
+	for (size_t i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		keys[i] = (long long)(x >> 1);
+	}
+	// one probe in four hits
+	for (size_t i = 0; i < probes.size(); ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		probes[i] = i % 4 == 0 ? keys[x % n] : (long long)(x >> 1);
+	}
+	run<sjtu::linked_hashmap<long long, blob> >("linked_hashmap", keys, probes);
+	run<sjtu::split_linked_hashmap<long long, blob> >("split_linked_hashmap", keys, probes);
+	return 0;
+}
@@ -0,0 +1,110 @@
+// parallel ingestion of (key, payload) rows, first value of a key wins:
+//   locked map     - one linked_hashmap behind a std::mutex
+//   stamped shards - a linked_hashmap per thread, stamped with the row
+//                    index, then merged with merge_stamped()
+//   copy merge     - the same shards merged by copying each element into
+//                    the result in stamp order
+// The stamped results equal a sequential insert in row order; the locked
+// map's order depends on the interleaving of the threads.
+//   usage: bench_stamped_merge [rows] [keys]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "linked_hashmap.hpp"
+#include "stamped_shards.hpp"
+
+typedef sjtu::linked_hashmap<std::string, std::string> map_type;
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+struct row {
+	std::string key;
+	std::string payload;
+};
+
+template<class F>
+static void on_threads(size_t threads, F fn) {
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threads; ++t) workers.emplace_back(fn, t);
+	for (size_t t = 0; t < threads; ++t) workers[t].join();
+}
+
+static unsigned long long order_checksum(const map_type &map) {
+	unsigned long long sum = 0, position = 0;
+	for (map_type::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		sum += ++position * std::hash<std::string>()(it->second);
+	}
+	return sum;
+}
+
+static void run(const std::vector<row> &rows, size_t threads) {
+	size_t n = rows.size();
+
+	map_type locked;
+	std::mutex lock;
+	clock_type::time_point t0 = clock_type::now();
+	on_threads(threads, [&](size_t t) {
+		for (size_t i = t; i < n; i += threads) {
+			std::lock_guard<std::mutex> guard(lock);
+			locked.try_emplace(rows[i].key, rows[i].payload);
+		}
+	});
+	double locked_time = seconds_since(t0);
+
+	sjtu::stamped_shards<std::string, std::string> shards(threads);
+	t0 = clock_type::now();
+	on_threads(threads, [&](size_t t) {
+		for (size_t i = t; i < n; i += threads) shards[t].insert(rows[i].key, rows[i].payload, i);
+	});
+	double ingest_time = seconds_since(t0);
+	t0 = clock_type::now();
+	map_type merged;
+	shards.merge_into(merged);
+	double merge_time = seconds_since(t0);
+
+	// the same shards again, merged by copying the keys
+	on_threads(threads, [&](size_t t) {
+		for (size_t i = t; i < n; i += threads) shards[t].insert(rows[i].key, rows[i].payload, i);
+	});
+	t0 = clock_type::now();
+	map_type copied;
+	{
+		std::vector<map_type::const_iterator> cursor(threads);
+		for (size_t t = 0; t < threads; ++t) cursor[t] = shards[t].elements().cbegin();
+		// row i went to shard i % threads, which kept it if its payload is next
+		for (size_t i = 0; i < n; ++i) {
+			size_t t = i % threads;
+			if (cursor[t] == shards[t].elements().cend() || cursor[t]->second != rows[i].payload) continue;
+			copied.try_emplace(cursor[t]->first, cursor[t]->second);
+			++cursor[t];
+		}
+	}
+	shards.clear();
+	double copy_time = seconds_since(t0);
+
+	std::printf("threads %zu  locked map %6.1f ns/row  stamped shards %6.1f + merge %5.1f ns/row  copy merge %5.1f ns/row"
+	            "  (%zu keys, %s)\n", threads, locked_time * 1e9 / n, ingest_time * 1e9 / n, merge_time * 1e9 / n,
+	            copy_time * 1e9 / n, merged.size(),
+	            order_checksum(merged) == order_checksum(copied) && merged.size() == locked.size() ? "same" : "MISMATCH");
+}
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+	size_t keys = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+	std::vector<row> rows(n);
+	unsigned long long x = 88172645463325252ull;
+	for (size_t i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		rows[i] = row{"user/" + std::to_string(x % keys), "{\"event\": " + std::to_string(i) + ", \"source\": \"ingest\", \"v\": 2}"};
+	}
+	const size_t thread_counts[] = {1, 2, 4};
+	for (size_t threads : thread_counts) run(rows, threads);
+	return 0;
+}
@@ -0,0 +1,58 @@
+// Time to destroy and to clear() a large map, for trivially destructible
+// entries (slabs freed wholesale) and for std::string values (every entry
+// destroyed), and for a map living in a monotonic arena.
+//   usage: bench_teardown [entries]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <string>
+#include "linked_hashmap.hpp"
+
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+template<class Map, class Make>
+static void fill(Map &map, int n, Make make) {
+	for (int i = 0; i < n; ++i) map[(long long)i * 2654435761ll] = make(i);
+}
+
+template<class Map, class Make>
+static void run(const char *name, int n, Make make) {
+	Map *map = new Map();
+	fill(*map, n, make);
+	clock_type::time_point t0 = clock_type::now();
+	map->clear();
+	double clear = seconds_since(t0);
+
+	fill(*map, n, make);
+	t0 = clock_type::now();
+	delete map;
+	double destroy = seconds_since(t0);
+	std::printf("%-14s clear %8.2f ms   destroy %8.2f ms\n", name, clear * 1e3, destroy * 1e3);
+}
+
+int main(int argc, char **argv) {
+	int n = argc > 1 ? std::atoi(argv[1]) : 4000000;
+	std::printf("entries %d\n", n);
+	run<sjtu::linked_hashmap<long long, long long> >("long long", n, [](int i) { return (long long)i; });
+	run<sjtu::linked_hashmap<long long, std::string> >("std::string", n, [](int i) { return std::to_string(i); });
+
+	clock_type::time_point t0;
+	{
+		std::pmr::monotonic_buffer_resource arena;
+		{
+			sjtu::pmr::linked_hashmap<long long, long long> map(&arena);
+			fill(map, n, [](int i) { return (long long)i; });
+			t0 = clock_type::now();
+		}
+		double destroy = seconds_since(t0);
+		t0 = clock_type::now();
+		std::printf("pmr arena      destroy %8.2f ms", destroy * 1e3);
+	}
+	std::printf("   arena release %8.2f ms\n", seconds_since(t0) * 1e3);
+	return 0;
+}
@@ -0,0 +1,70 @@
+// counting with linked_hashmap, the most common read-modify-write:
+//   count + at    - count(), then at() or insert() (two probes a row)
+//   operator[]    - map[key] += 1
+//   merge         - map.merge(key, 1, add)
+//   compute       - map.compute(key, fn) returning the new count
+// over string and integer keys with a Zipf-like mix of repeats.
+//   usage: bench_update_in_place [rows] [keys]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+template<class Key>
+static void run(const char *name, const std::vector<Key> &rows) {
+	typedef sjtu::linked_hashmap<Key, long long> map_type;
+	size_t n = rows.size();
+	long long check[4];
+	double time[4];
+	for (int how = 0; how < 4; ++how) {
+		map_type map;
+		clock_type::time_point t0 = clock_type::now();
+		for (size_t i = 0; i < n; ++i) {
+			const Key &key = rows[i];
+			if (how == 0) {
+				if (map.count(key)) map.at(key) += 1;
+				else map.insert(typename map_type::value_type(key, 1));
+			} else if (how == 1) {
+				map[key] += 1;
+			} else if (how == 2) {
+				map.merge(key, 1, [](long long &count, int one) { count += one; });
+			} else {
+				map.compute(key, [](const Key &, long long *count) {
+					return std::optional<long long>(count ? *count + 1 : 1);
+				});
+			}
+		}
+		time[how] = seconds_since(t0) * 1e9 / n;
+		check[how] = (long long)map.size() * 31 + map.cbegin()->second;
+	}
+	std::printf("%-8s count + at %6.1f  operator[] %6.1f  merge %6.1f  compute %6.1f ns/row  (%s)\n", name,
+	            time[0], time[1], time[2], time[3],
+	            check[0] == check[1] && check[1] == check[2] && check[2] == check[3] ? "same counts" : "MISMATCH");
+}
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+	size_t keys = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+	std::vector<long long> integers(n);
+	std::vector<std::string> strings(n);
+	unsigned long long x = 88172645463325252ull;
+	for (size_t i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		// the product of two uniforms favours small ranks
+		unsigned long long rank = (x % keys) * ((x >> 32) % keys) / keys;
+		integers[i] = (long long)(rank * 2654435761u);
+		strings[i] = "counter/" + std::to_string(rank);
+	}
+	run("integer", integers);
+	run("string", strings);
+	return 0;
+}
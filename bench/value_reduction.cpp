@@ -0,0 +1,62 @@
+// Sum, min and count over all values: iterator walk (as in data/testsix)
+// versus the slab-scanning aggregates.
+//   usage: bench_value_reduction [entries]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "linked_hashmap.hpp"
+
+typedef sjtu::linked_hashmap<int, int> map_type;
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t0) {
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+	int n = argc > 1 ? std::atoi(argv[1]) : 4000000;
+	map_type map;
+	unsigned int x = 2463534242u;
+	for (int i = 0; i < n; ++i) {
+		x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+		map[(int)(x >> 1)] = (int)(x % 1000);
+	}
+	// leave holes in the slabs, as a map with erasures has
+	for (int i = 0; i < n / 4; ++i) {
+		x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+		map_type::iterator it = map.find((int)(x >> 1));
+		if (it != map.end()) map.erase(it);
+	}
+	const int rounds = 10;
+
+	long long sum = 0;
+	int low = 1 << 30;
+	size_t big = 0;
+	clock_type::time_point t0 = clock_type::now();
+	for (int r = 0; r < rounds; ++r) {
+		for (map_type::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+			sum += it->second;
+			if (it->second < low) low = it->second;
+			if (it->second > 500) ++big;
+		}
+	}
+	double walk = seconds_since(t0);
+
+	long long sum2 = 0;
+	int low2 = 0;
+	size_t big2 = 0;
+	t0 = clock_type::now();
+	for (int r = 0; r < rounds; ++r) {
+		sum2 += map.sum_values<long long>();
+		low2 = map.min_value();
+		big2 += map.count_values_if([](int v) { return v > 500; });
+	}
+	double scan = seconds_since(t0);
+
+	std::printf("entries %zu\n", map.size());
+	std::printf("iterator walk   %7.2f ns/entry  (sum %lld min %d count %zu)\n",
+	            walk * 1e9 / rounds / map.size(), sum, low, big);
+	std::printf("slab aggregates %7.2f ns/entry  (sum %lld min %d count %zu)\n",
+	            scan * 1e9 / rounds / map.size(), sum2, low2, big2);
+	return 0;
+}
@@ -0,0 +1,753 @@
+/**
+ * bounded caches built on linked_hashmap.
+ *
+ * Each cache keeps its eviction order in the iteration order of a
+ * linked_hashmap and reorders it in O(1) with move_before() and
+ * move_to_back(), so a hit costs one lookup and a relink, with no second
+ * index over the keys. They share one interface:
+ *
+ *   V * get(const Key &key);            the cached value or nullptr;
+ *                                       counts a hit or a miss and
+ *                                       updates the order
+ *   void put(const Key &key, V value);  inserts or overwrites, evicting
+ *                                       as the policy says when full
+ *   bool contains(const Key &key) const;    leaves the order alone
+ *   size_t size() const;  size_t capacity() const;
+ *   cache_stats stats() const;
+ *
+ *   lru_cache       - least recently used
+ *   lfu_cache       - least frequently used, least recently used among
+ *                     equal counts; O(1) through frequency groups
+ *   two_queue_cache - 2Q (Johnson & Shasha): new keys go through a FIFO
+ *                     and only reach the LRU part when they come back
+ *                     soon after leaving it, so scans do not flush it
+ *   arc_cache       - ARC (Megiddo & Modha): adapts the split between
+ *                     recency and frequency using ghost lists of
+ *                     recently evicted keys
+ *   clock_cache     - CLOCK (second chance) for use from several threads:
+ *                     a hit sets a flag instead of relinking, so get()
+ *                     only needs a shared lock; get() copies the value
+ *                     out instead of returning a pointer. A shared_mutex
+ *                     costs several times a mutex to take, so this only
+ *                     beats lru_cache behind a mutex when readers run on
+ *                     several cores at once
+ *
+ * lru_cache can also put a TinyLFU admission filter in front of its
+ * evictions, see lru_cache::enable_admission(), weigh its entries with a
+ * Weigher so that capacity bounds their total weight, and hand evicted
+ * entries to a listener, see lru_cache::on_evict().
+ *
+ * A capacity of 0 throws runtime_error.
+ */
+#ifndef SJTU_CACHE_HPP
+#define SJTU_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "exceptions.hpp"
+#include "frequency_sketch.hpp"
+#include "linked_hashmap.hpp"
+
+namespace sjtu {
+
+struct cache_stats {
+	size_t hits;
+	size_t misses;
+	size_t evictions;
+	size_t rejections;  // new keys the admission filter kept out
+
+	double hit_ratio() const {
+		return hits + misses ? (double)hits / (hits + misses) : 0.0;
+	}
+};
+
+namespace detail {
+
+// a small number for the calling thread, handed out in order of first
+// use; spreads threads over striped counters
+inline size_t thread_stripe() {
+	static std::atomic<size_t> next(0);
+	thread_local size_t stripe = next.fetch_add(1, std::memory_order_relaxed);
+	return stripe;
+}
+
+}
+
+/**
+ * the default weigher: every entry weighs 1, so capacity counts entries.
+ */
+struct unit_weigher {
+	template<class Key, class V>
+	size_t operator()(const Key &, const V &) const {
+		return 1;
+	}
+};
+
+template<class Key, class V, class Hash = std::hash<Key>, class Equal = std::equal_to<Key>,
+         class Weigher = unit_weigher>
+class lru_cache {
+public:
+	/**
+	 * an evicted entry as handed to the eviction listener.
+	 */
+	typedef pair<Key, V> evicted_entry;
+	typedef std::function<void(evicted_entry *, size_t)> eviction_listener;
+
+private:
+	struct Entry {
+		V value;
+		size_t weight;
+	};
+	typedef linked_hashmap<Key, Entry, Hash, Equal> map_type;
+	typedef typename map_type::iterator entry_iterator;
+
+	map_type entries;  // least recently used first
+	size_t max_size;
+	size_t total_weight;
+	cache_stats counters;
+	Weigher weigher;
+	detail::frequency_sketch sketch;  // empty unless admission is on
+	eviction_listener listener;
+	std::vector<evicted_entry> evicted;  // the batch for listener
+
+	// hands the batch to the listener; the cache is consistent by then
+	void flush_evicted() {
+		if (evicted.empty()) return;
+		struct clear_on_exit {
+			std::vector<evicted_entry> &batch;
+			~clear_on_exit() { batch.clear(); }
+		} guard{evicted};
+		listener(evicted.data(), evicted.size());
+	}
+
+	void evict(entry_iterator victim) {
+		if (listener) evicted.push_back(evicted_entry(victim->first, std::move(victim->second.value)));
+		total_weight -= victim->second.weight;
+		entries.erase(victim);
+		++counters.evictions;
+	}
+
+	// whether a new key with this hash and weight may displace the
+	// entries trim() would evict for it: it must have been requested more
+	// often lately than every one of them. Their hashes are the ones the
+	// map cached, so the scan calls no hash function.
+	bool admit(size_t hash, size_t weight) const {
+		if (sketch.empty()) return true;
+		unsigned frequency = sketch.estimate(hash);
+		size_t remaining = total_weight;
+		for (typename map_type::const_iterator it = entries.cbegin(); remaining + weight > max_size; ++it) {
+			if (frequency <= sketch.estimate(entries.hash_of(it))) return false;
+			remaining -= it->second.weight;
+		}
+		return true;
+	}
+
+	// evicts the least recently used entries until the rest fit
+	void trim() {
+		while (total_weight > max_size) evict(entries.begin());
+	}
+
+public:
+	/**
+	 * capacity is the largest total weight of the entries; with the
+	 *   unit_weigher, the number of entries.
+	 */
+	explicit lru_cache(size_t capacity, const Weigher &weigher = Weigher())
+		: max_size(capacity), total_weight(0), counters(), weigher(weigher) {
+		if (capacity == 0) throw runtime_error();
+		if (std::is_same<Weigher, unit_weigher>::value) entries.reserve(capacity);
+	}
+
+	/**
+	 * TinyLFU admission: every get() and put() is counted in a count-min
+	 *   sketch whose counts are halved periodically, and when the cache is
+	 *   full a new key only displaces the least recently used entries it
+	 *   needs room from if it has been requested more often lately than
+	 *   each of them. Keys seen once, as in a scan, then no longer flush
+	 *   the cache; a rejected put() counts in stats().rejections and its
+	 *   entry goes to the eviction listener. The sketch is sized for expected_entries keys,
+	 *   capacity() if 0, at 8 bytes per key.
+	 */
+	void enable_admission(size_t expected_entries = 0) {
+		sketch.reset(expected_entries ? expected_entries : max_size);
+	}
+
+	void disable_admission() {
+		sketch.release();
+	}
+
+	/**
+	 * listener(batch, n) receives the entries an operation evicted, once
+	 *   per operation and after the cache has been updated; it may move
+	 *   the values out, e.g. to a lower tier. An entry heavier than
+	 *   capacity(), or one the admission filter rejected, is handed over
+	 *   without being inserted. Pass an empty
+	 *   function to drop evicted entries again.
+	 */
+	void on_evict(eviction_listener listener) {
+		this->listener = std::move(listener);
+	}
+
+	V * get(const Key &key) {
+		if (!sketch.empty()) sketch.add(Hash()(key));
+		entry_iterator it = entries.find(key);
+		if (it == entries.end()) {
+			++counters.misses;
+			return nullptr;
+		}
+		++counters.hits;
+		entries.move_to_back(it);
+		return &it->second.value;
+	}
+
+	/**
+	 * inserts or overwrites the entry of key, then evicts the least
+	 *   recently used entries until the total weight fits again.
+	 */
+	void put(const Key &key, V value) {
+		size_t hash = 0;
+		if (!sketch.empty()) sketch.add(hash = Hash()(key));
+		size_t weight = weigher(key, value);
+		entry_iterator it = entries.find(key);
+		if (weight > max_size) {
+			if (it != entries.end()) evict(it);
+			if (listener) evicted.push_back(evicted_entry(key, std::move(value)));
+			++counters.evictions;
+			flush_evicted();
+			return;
+		}
+		if (it != entries.end()) {
+			it->second.value = std::move(value);
+			total_weight = total_weight - it->second.weight + weight;
+			it->second.weight = weight;
+			entries.move_to_back(it);
+		} else {
+			if (total_weight + weight > max_size && !admit(hash, weight)) {
+				if (listener) evicted.push_back(evicted_entry(key, std::move(value)));
+				++counters.rejections;
+				flush_evicted();
+				return;
+			}
+			entries.emplace(key, Entry{std::move(value), weight});
+			total_weight += weight;
+		}
+		trim();
+		flush_evicted();
+	}
+
+	bool contains(const Key &key) const {
+		return entries.contains(key);
+	}
+
+	size_t size() const {
+		return entries.size();
+	}
+
+	size_t capacity() const {
+		return max_size;
+	}
+
+	// the total weight of the entries
+	size_t weight() const {
+		return total_weight;
+	}
+
+	cache_stats stats() const {
+		return counters;
+	}
+};
+
+template<class Key, class V, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class lfu_cache {
+private:
+	struct Entry {
+		V value;
+		size_t freq;
+	};
+	typedef linked_hashmap<Key, Entry, Hash, Equal> map_type;
+	typedef typename map_type::iterator entry_iterator;
+
+	// by ascending frequency, least recently used first within one
+	map_type entries;
+	// the last entry of every frequency present
+	linked_hashmap<size_t, entry_iterator> group_last;
+	size_t max_size;
+	cache_stats counters;
+
+	// moves it from its frequency group to the back of the next one
+	void touch(entry_iterator it) {
+		size_t freq = it->second.freq;
+		entry_iterator *last = group_last.find_ptr(freq);
+		entry_iterator *next_last = group_last.find_ptr(freq + 1);
+		entry_iterator target = next_last ? *next_last : *last;
+		if (*last == it) {
+			entry_iterator prev = it;
+			if (it != entries.begin() && (--prev)->second.freq == freq) {
+				*last = prev;
+			} else {
+				group_last.erase(group_last.find(freq));
+			}
+		}
+		if (target != it) {
+			entries.move_before(it, ++target);
+		}
+		it->second.freq = freq + 1;
+		group_last[freq + 1] = it;
+	}
+
+	void evict() {
+		entry_iterator victim = entries.begin();
+		typename linked_hashmap<size_t, entry_iterator>::iterator last = group_last.find(victim->second.freq);
+		if (last->second == victim) group_last.erase(last);
+		entries.erase(victim);
+		++counters.evictions;
+	}
+
+public:
+	explicit lfu_cache(size_t capacity) : max_size(capacity), counters() {
+		if (capacity == 0) throw runtime_error();
+		entries.reserve(capacity);
+	}
+
+	// group_last points into entries
+	lfu_cache(const lfu_cache &) = delete;
+	lfu_cache & operator=(const lfu_cache &) = delete;
+
+	V * get(const Key &key) {
+		entry_iterator it = entries.find(key);
+		if (it == entries.end()) {
+			++counters.misses;
+			return nullptr;
+		}
+		++counters.hits;
+		touch(it);
+		return &it->second.value;
+	}
+
+	void put(const Key &key, V value) {
+		entry_iterator it = entries.find(key);
+		if (it != entries.end()) {
+			it->second.value = std::move(value);
+			touch(it);
+			return;
+		}
+		if (entries.size() >= max_size) evict();
+		it = entries.emplace(key, Entry{std::move(value), 1}).first;
+		entry_iterator *last = group_last.find_ptr(1);
+		if (last) {
+			entry_iterator after = *last;
+			entries.move_before(it, ++after);
+			*last = it;
+		} else {
+			entries.move_to_front(it);
+			group_last[1] = it;
+		}
+	}
+
+	bool contains(const Key &key) const {
+		return entries.contains(key);
+	}
+
+	size_t size() const {
+		return entries.size();
+	}
+
+	size_t capacity() const {
+		return max_size;
+	}
+
+	cache_stats stats() const {
+		return counters;
+	}
+};
+
+template<class Key, class V, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class two_queue_cache {
+private:
+	struct Entry {
+		V value;
+		bool main;  // in Am rather than A1in
+	};
+	typedef linked_hashmap<Key, Entry, Hash, Equal> map_type;
+	typedef typename map_type::iterator entry_iterator;
+	typedef linked_hashmap<Key, char, Hash, Equal> ghost_map;
+
+	// the A1in FIFO (oldest first), then the Am LRU (least recent first)
+	map_type entries;
+	entry_iterator main_first;  // first Am entry, or end()
+	size_t in_count;
+	// A1out: keys recently pushed out of A1in, oldest first
+	ghost_map ghosts;
+	size_t max_size, in_max, ghost_max;
+	cache_stats counters;
+
+	void touch(entry_iterator it) {
+		if (!it->second.main) return;
+		if (it == main_first) {
+			entry_iterator next = it;
+			if (++next == entries.end()) return;
+			main_first = next;
+		}
+		entries.move_to_back(it);
+	}
+
+	void reclaim() {
+		if (entries.size() < max_size) return;
+		if (in_count > 0 && (in_count > in_max || main_first == entries.end())) {
+			entry_iterator victim = entries.begin();
+			ghosts.emplace(victim->first, 0);
+			if (ghosts.size() > ghost_max) ghosts.erase(ghosts.begin());
+			entries.erase(victim);
+			--in_count;
+		} else {
+			entry_iterator victim = main_first;
+			++main_first;
+			entries.erase(victim);
+		}
+		++counters.evictions;
+	}
+
+public:
+	/**
+	 * A1in holds up to a quarter of capacity, A1out remembers up to half
+	 *   of capacity keys, as the 2Q paper suggests.
+	 */
+	explicit two_queue_cache(size_t capacity)
+		: in_count(0), max_size(capacity), in_max(capacity / 4 ? capacity / 4 : 1),
+		  ghost_max(capacity / 2 ? capacity / 2 : 1), counters() {
+		if (capacity == 0) throw runtime_error();
+		entries.reserve(capacity);
+		main_first = entries.end();
+	}
+
+	// main_first points into entries
+	two_queue_cache(const two_queue_cache &) = delete;
+	two_queue_cache & operator=(const two_queue_cache &) = delete;
+
+	V * get(const Key &key) {
+		entry_iterator it = entries.find(key);
+		if (it == entries.end()) {
+			++counters.misses;
+			return nullptr;
+		}
+		++counters.hits;
+		touch(it);
+		return &it->second.value;
+	}
+
+	void put(const Key &key, V value) {
+		entry_iterator it = entries.find(key);
+		if (it != entries.end()) {
+			it->second.value = std::move(value);
+			touch(it);
+			return;
+		}
+		typename ghost_map::iterator ghost = ghosts.find(key);
+		if (ghost != ghosts.end()) {
+			ghosts.erase(ghost);
+			reclaim();
+			it = entries.emplace(key, Entry{std::move(value), true}).first;
+			if (main_first == entries.end()) main_first = it;
+		} else {
+			reclaim();
+			it = entries.emplace(key, Entry{std::move(value), false}).first;
+			entries.move_before(it, main_first);
+			++in_count;
+		}
+	}
+
+	bool contains(const Key &key) const {
+		return entries.contains(key);
+	}
+
+	size_t size() const {
+		return entries.size();
+	}
+
+	size_t capacity() const {
+		return max_size;
+	}
+
+	cache_stats stats() const {
+		return counters;
+	}
+};
+
+template<class Key, class V, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class arc_cache {
+private:
+	struct Entry {
+		V value;
+		bool frequent;  // in T2 rather than T1
+	};
+	typedef linked_hashmap<Key, Entry, Hash, Equal> map_type;
+	typedef typename map_type::iterator entry_iterator;
+	typedef linked_hashmap<Key, char, Hash, Equal> ghost_map;
+
+	// T1 then T2, least recently used first in each
+	map_type entries;
+	entry_iterator t2_first;  // first T2 entry, or end()
+	size_t t1_count;
+	// B1 and B2: keys recently evicted from T1 and T2, oldest first
+	ghost_map b1, b2;
+	size_t max_size;
+	size_t target;  // the size T1 is steered towards
+	cache_stats counters;
+
+	// a hit: to the most recent end of T2
+	void touch(entry_iterator it) {
+		if (!it->second.frequent) {
+			it->second.frequent = true;
+			--t1_count;
+			entries.move_to_back(it);
+			if (t2_first == entries.end()) t2_first = it;
+			return;
+		}
+		if (it == t2_first) {
+			entry_iterator next = it;
+			if (++next == entries.end()) return;
+			t2_first = next;
+		}
+		entries.move_to_back(it);
+	}
+
+	// makes room for one entry when the cache is full, taking it from T1
+	// or T2 depending on target
+	void replace(bool in_b2) {
+		if (entries.size() < max_size) return;
+		if (t1_count > 0 && (t1_count > target || (in_b2 && t1_count == target) || t2_first == entries.end())) {
+			entry_iterator victim = entries.begin();
+			b1.emplace(victim->first, 0);
+			entries.erase(victim);
+			--t1_count;
+		} else {
+			entry_iterator victim = t2_first;
+			++t2_first;
+			b2.emplace(victim->first, 0);
+			entries.erase(victim);
+		}
+		++counters.evictions;
+	}
+
+	void insert_frequent(const Key &key, V &&value) {
+		entry_iterator it = entries.emplace(key, Entry{std::move(value), true}).first;
+		if (t2_first == entries.end()) t2_first = it;
+	}
+
+public:
+	explicit arc_cache(size_t capacity) : t1_count(0), max_size(capacity), target(0), counters() {
+		if (capacity == 0) throw runtime_error();
+		entries.reserve(capacity);
+		t2_first = entries.end();
+	}
+
+	// t2_first points into entries
+	arc_cache(const arc_cache &) = delete;
+	arc_cache & operator=(const arc_cache &) = delete;
+
+	V * get(const Key &key) {
+		entry_iterator it = entries.find(key);
+		if (it == entries.end()) {
+			++counters.misses;
+			return nullptr;
+		}
+		++counters.hits;
+		touch(it);
+		return &it->second.value;
+	}
+
+	void put(const Key &key, V value) {
+		entry_iterator it = entries.find(key);
+		if (it != entries.end()) {
+			it->second.value = std::move(value);
+			touch(it);
+			return;
+		}
+
+		typename ghost_map::iterator ghost = b1.find(key);
+		if (ghost != b1.end()) {
+			// T1 was too small: grow its target
+			size_t delta = b2.size() > b1.size() ? b2.size() / b1.size() : 1;
+			target = target + delta < max_size ? target + delta : max_size;
+			b1.erase(ghost);
+			replace(false);
+			insert_frequent(key, std::move(value));
+			return;
+		}
+		ghost = b2.find(key);
+		if (ghost != b2.end()) {
+			// T2 was too small: shrink T1's target
+			size_t delta = b1.size() > b2.size() ? b1.size() / b2.size() : 1;
+			target = target > delta ? target - delta : 0;
+			b2.erase(ghost);
+			replace(true);
+			insert_frequent(key, std::move(value));
+			return;
+		}
+
+		if (t1_count + b1.size() >= max_size) {
+			if (t1_count < max_size) {
+				b1.erase(b1.begin());
+				replace(false);
+			} else {
+				// T1 fills the cache and B1 is empty: drop T1's oldest
+				entries.erase(entries.begin());
+				--t1_count;
+				++counters.evictions;
+			}
+		} else if (entries.size() + b1.size() + b2.size() >= max_size) {
+			if (entries.size() + b1.size() + b2.size() >= 2 * max_size) b2.erase(b2.begin());
+			replace(false);
+		}
+		it = entries.emplace(key, Entry{std::move(value), false}).first;
+		entries.move_before(it, t2_first);
+		++t1_count;
+	}
+
+	bool contains(const Key &key) const {
+		return entries.contains(key);
+	}
+
+	size_t size() const {
+		return entries.size();
+	}
+
+	size_t capacity() const {
+		return max_size;
+	}
+
+	cache_stats stats() const {
+		return counters;
+	}
+};
+
+template<class Key, class V, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class clock_cache {
+private:
+	struct Entry {
+		V value;
+		mutable std::atomic<bool> referenced;
+
+		explicit Entry(V &&v) : value(std::move(v)), referenced(false) {}
+	};
+	typedef linked_hashmap<Key, Entry, Hash, Equal> map_type;
+	typedef typename map_type::iterator entry_iterator;
+
+	// the clock face, in insertion order; new entries go just behind hand
+	map_type entries;
+	entry_iterator hand;  // the next entry to examine, or end()
+	size_t max_size;
+	mutable std::shared_mutex lock;
+	size_t evictions;
+
+	// hit and miss counts, striped by thread over separate cache lines so
+	// that concurrent get()s do not all increment the same word
+	static const size_t STRIPES = 16;
+	struct alignas(64) Counter {
+		std::atomic<size_t> hits, misses;
+
+		Counter() : hits(0), misses(0) {}
+	};
+	mutable Counter counters[STRIPES];
+
+	Counter & counter() const {
+		return counters[detail::thread_stripe() % STRIPES];
+	}
+
+	// clears the flags in front of the hand up to the first entry without
+	// one and evicts that entry; the hand then points after it
+	void evict() {
+		for (;;) {
+			if (hand == entries.end()) hand = entries.begin();
+			if (!hand->second.referenced.load(std::memory_order_relaxed)) break;
+			hand->second.referenced.store(false, std::memory_order_relaxed);
+			++hand;
+		}
+		entry_iterator victim = hand++;
+		entries.erase(victim);
+		++evictions;
+	}
+
+public:
+	explicit clock_cache(size_t capacity)
+		: max_size(capacity), evictions(0) {
+		if (capacity == 0) throw runtime_error();
+		entries.reserve(capacity);
+		hand = entries.end();
+	}
+
+	// hand points into entries
+	clock_cache(const clock_cache &) = delete;
+	clock_cache & operator=(const clock_cache &) = delete;
+
+	/**
+	 * copies the cached value into value and returns true, or returns
+	 *   false. Only takes the lock shared: a hit marks the entry with a
+	 *   relaxed atomic store and leaves the order alone, and the hit is
+	 *   counted in this thread's stripe of the counters.
+	 */
+	bool get(const Key &key, V &value) const {
+		std::shared_lock<std::shared_mutex> guard(lock);
+		const Entry *entry = entries.find_ptr(key);
+		if (!entry) {
+			counter().misses.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		counter().hits.fetch_add(1, std::memory_order_relaxed);
+		if (!entry->referenced.load(std::memory_order_relaxed)) {
+			entry->referenced.store(true, std::memory_order_relaxed);
+		}
+		value = entry->value;
+		return true;
+	}
+
+	void put(const Key &key, V value) {
+		std::unique_lock<std::shared_mutex> guard(lock);
+		Entry *entry = entries.find_ptr(key);
+		if (entry) {
+			entry->value = std::move(value);
+			entry->referenced.store(true, std::memory_order_relaxed);
+			return;
+		}
+		if (entries.size() >= max_size) evict();
+		entry_iterator it = entries.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+		                                    std::forward_as_tuple(std::move(value))).first;
+		if (hand != entries.end()) entries.move_before(it, hand);
+	}
+
+	bool contains(const Key &key) const {
+		std::shared_lock<std::shared_mutex> guard(lock);
+		return entries.contains(key);
+	}
+
+	size_t size() const {
+		std::shared_lock<std::shared_mutex> guard(lock);
+		return entries.size();
+	}
+
+	size_t capacity() const {
+		return max_size;
+	}
+
+	cache_stats stats() const {
+		std::shared_lock<std::shared_mutex> guard(lock);
+		cache_stats result = cache_stats();
+		for (size_t i = 0; i < STRIPES; ++i) {
+			result.hits += counters[i].hits.load(std::memory_order_relaxed);
+			result.misses += counters[i].misses.load(std::memory_order_relaxed);
+		}
+		result.evictions = evictions;
+		return result;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+typedef sjtu::linked_hashmap<int, int> map_type;
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// rows with plenty of repeated keys, so first-wins matters
+static std::vector<std::pair<int, int> > make_rows(size_t n, int range) {
+	std::vector<std::pair<int, int> > rows;
+	for (size_t i = 0; i < n; ++i) rows.push_back(std::make_pair((int)(next_rand() % range), (int)i));
+	return rows;
+}
+
+// whether a and b hold the same elements in the same order
+static bool same(const map_type &a, const map_type &b) {
+	if (a.size() != b.size()) return false;
+	map_type::const_iterator x = a.cbegin(), y = b.cbegin();
+	for (; x != a.cend(); ++x, ++y) {
+		if (x->first != y->first || x->second != y->second) return false;
+	}
+	return true;
+}
+
+static long long checksum(const map_type &map) {
+	long long sum = 0, position = 0;
+	for (map_type::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		sum += ++position * (it->first ^ (it->second * 31));
+	}
+	return sum;
+}
+
+void test_bulk_insert() {
+	puts("Test: bulk_insert");
+	std::vector<std::pair<int, int> > rows = make_rows(300000, 200000);
+	map_type expected;
+	for (int i = 0; i < 1000; ++i) expected[i * 7] = -i;
+	map_type prefix(expected);
+	size_t expected_inserted = 0;
+	for (size_t i = 0; i < rows.size(); ++i) {
+		expected_inserted += expected.insert(map_type::value_type(rows[i].first, rows[i].second)).second;
+	}
+	printf("sequential: inserted %d, size %d, checksum %lld\n", (int)expected_inserted, (int)expected.size(),
+	       checksum(expected));
+	for (size_t threads = 1; threads <= 8; threads *= 2) {
+		sjtu::thread_pool pool(threads);
+		map_type map(prefix);
+		size_t inserted = map.bulk_insert(rows.begin(), rows.end(), &pool);
+		printf("%d threads: inserted %d, same order %s\n", (int)threads, (int)inserted,
+		       same(map, expected) ? "yes" : "no");
+	}
+}
+
+void test_range_constructor() {
+	puts("Test: range constructor");
+	std::vector<std::pair<int, int> > rows = make_rows(100000, 50000);
+	map_type expected;
+	for (size_t i = 0; i < rows.size(); ++i) expected.insert(map_type::value_type(rows[i].first, rows[i].second));
+	for (size_t threads = 1; threads <= 4; threads *= 2) {
+		map_type map(rows.begin(), rows.end(), threads);
+		printf("%d threads: size %d, same order %s\n", (int)threads, (int)map.size(), same(map, expected) ? "yes" : "no");
+		// the map keeps working after the parallel build
+		map.erase(map.find(rows[0].first));
+		map[-1] = 1;
+		printf("after erase and insert: size %d, last key %d\n", (int)map.size(), (--map.end())->first);
+	}
+}
+
+void test_small() {
+	puts("Test: small input");
+	std::vector<std::pair<int, int> > rows;
+	for (int i = 0; i < 10; ++i) rows.push_back(std::make_pair(i % 4, i));
+	sjtu::thread_pool pool(4);
+	map_type map;
+	printf("inserted %d\n", (int)map.bulk_insert(rows.begin(), rows.end(), &pool));
+	for (map_type::const_iterator it = map.cbegin(); it != map.cend(); ++it) printf("%d -> %d\n", it->first, it->second);
+}
+
+int main() {
+	test_bulk_insert();
+	test_range_constructor();
+	test_small();
+	return 0;
+}
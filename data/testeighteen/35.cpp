@@ -0,0 +1,333 @@
+#include "cache.hpp"
+#include <cstdio>
+#include <list>
+#include <map>
+#include <utility>
+
+// straightforward reference versions of the policies, linear time but
+// written directly from their definitions
+
+class reference_lru {
+	std::list<std::pair<int, int> > order;  // least recent first
+	size_t cap;
+
+	std::list<std::pair<int, int> >::iterator locate(int key) {
+		for (std::list<std::pair<int, int> >::iterator it = order.begin(); it != order.end(); ++it) {
+			if (it->first == key) return it;
+		}
+		return order.end();
+	}
+
+public:
+	explicit reference_lru(size_t cap) : cap(cap) {}
+
+	int * get(int key) {
+		std::list<std::pair<int, int> >::iterator it = locate(key);
+		if (it == order.end()) return nullptr;
+		order.splice(order.end(), order, it);
+		return &it->second;
+	}
+
+	void put(int key, int value) {
+		std::list<std::pair<int, int> >::iterator it = locate(key);
+		if (it != order.end()) {
+			it->second = value;
+			order.splice(order.end(), order, it);
+			return;
+		}
+		order.push_back(std::make_pair(key, value));
+		if (order.size() > cap) order.pop_front();
+	}
+
+	bool contains(int key) {
+		return locate(key) != order.end();
+	}
+};
+
+// least frequently used, least recently used among equal counts
+class reference_lfu {
+	struct entry {
+		int value;
+		long freq;
+		long used;
+	};
+	std::map<int, entry> entries;
+	size_t cap;
+	long clock;
+
+public:
+	explicit reference_lfu(size_t cap) : cap(cap), clock(0) {}
+
+	int * get(int key) {
+		std::map<int, entry>::iterator it = entries.find(key);
+		if (it == entries.end()) return nullptr;
+		it->second.freq++;
+		it->second.used = ++clock;
+		return &it->second.value;
+	}
+
+	void put(int key, int value) {
+		std::map<int, entry>::iterator it = entries.find(key);
+		if (it != entries.end()) {
+			it->second.value = value;
+			it->second.freq++;
+			it->second.used = ++clock;
+			return;
+		}
+		if (entries.size() >= cap) {
+			std::map<int, entry>::iterator victim = entries.begin();
+			for (it = entries.begin(); it != entries.end(); ++it) {
+				if (it->second.freq < victim->second.freq ||
+				    (it->second.freq == victim->second.freq && it->second.used < victim->second.used)) {
+					victim = it;
+				}
+			}
+			entries.erase(victim);
+		}
+		entry e = {value, 1, ++clock};
+		entries[key] = e;
+	}
+
+	bool contains(int key) {
+		return entries.count(key) != 0;
+	}
+};
+
+// the full 2Q of Johnson and Shasha: A1in a FIFO, Am an LRU, A1out the
+// keys recently pushed out of A1in
+class reference_2q {
+	std::list<std::pair<int, int> > a1in, am;  // oldest first
+	std::list<int> a1out;                      // oldest first
+	size_t cap, kin, kout;
+
+	static std::list<std::pair<int, int> >::iterator locate(std::list<std::pair<int, int> > &l, int key) {
+		for (std::list<std::pair<int, int> >::iterator it = l.begin(); it != l.end(); ++it) {
+			if (it->first == key) return it;
+		}
+		return l.end();
+	}
+
+	void reclaim() {
+		if (a1in.size() + am.size() < cap) return;
+		if (!a1in.empty() && (a1in.size() > kin || am.empty())) {
+			a1out.push_back(a1in.front().first);
+			if (a1out.size() > kout) a1out.pop_front();
+			a1in.pop_front();
+		} else {
+			am.pop_front();
+		}
+	}
+
+public:
+	explicit reference_2q(size_t cap) : cap(cap), kin(cap / 4 ? cap / 4 : 1), kout(cap / 2 ? cap / 2 : 1) {}
+
+	int * get(int key) {
+		std::list<std::pair<int, int> >::iterator it = locate(am, key);
+		if (it != am.end()) {
+			am.splice(am.end(), am, it);
+			return &it->second;
+		}
+		it = locate(a1in, key);
+		return it == a1in.end() ? nullptr : &it->second;
+	}
+
+	void put(int key, int value) {
+		int *found = get(key);
+		if (found) {
+			*found = value;
+			return;
+		}
+		for (std::list<int>::iterator g = a1out.begin(); g != a1out.end(); ++g) {
+			if (*g != key) continue;
+			a1out.erase(g);
+			reclaim();
+			am.push_back(std::make_pair(key, value));
+			return;
+		}
+		reclaim();
+		a1in.push_back(std::make_pair(key, value));
+	}
+
+	bool contains(int key) {
+		return locate(am, key) != am.end() || locate(a1in, key) != a1in.end();
+	}
+};
+
+// ARC as given in Megiddo and Modha's paper (figure 4)
+class reference_arc {
+	std::list<std::pair<int, int> > t1, t2;  // least recent first
+	std::list<int> b1, b2;                   // least recent first
+	size_t c, p;
+
+	static std::list<std::pair<int, int> >::iterator locate(std::list<std::pair<int, int> > &l, int key) {
+		for (std::list<std::pair<int, int> >::iterator it = l.begin(); it != l.end(); ++it) {
+			if (it->first == key) return it;
+		}
+		return l.end();
+	}
+
+	static bool take(std::list<int> &l, int key) {
+		for (std::list<int>::iterator it = l.begin(); it != l.end(); ++it) {
+			if (*it == key) {
+				l.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void replace(bool in_b2) {
+		if (!t1.empty() && ((in_b2 && t1.size() == p) || t1.size() > p || t2.empty())) {
+			b1.push_back(t1.front().first);
+			t1.pop_front();
+		} else {
+			b2.push_back(t2.front().first);
+			t2.pop_front();
+		}
+	}
+
+public:
+	explicit reference_arc(size_t c) : c(c), p(0) {}
+
+	int * get(int key) {
+		std::list<std::pair<int, int> >::iterator it = locate(t1, key);
+		if (it != t1.end()) {
+			t2.splice(t2.end(), t1, it);
+			return &it->second;
+		}
+		it = locate(t2, key);
+		if (it != t2.end()) {
+			t2.splice(t2.end(), t2, it);
+			return &it->second;
+		}
+		return nullptr;
+	}
+
+	void put(int key, int value) {
+		int *found = get(key);
+		if (found) {
+			*found = value;
+			return;
+		}
+		if (take(b1, key)) {
+			size_t delta = b2.size() > b1.size() + 1 ? b2.size() / (b1.size() + 1) : 1;
+			p = p + delta < c ? p + delta : c;
+			replace(false);
+			t2.push_back(std::make_pair(key, value));
+			return;
+		}
+		if (take(b2, key)) {
+			size_t delta = b1.size() > b2.size() + 1 ? b1.size() / (b2.size() + 1) : 1;
+			p = p > delta ? p - delta : 0;
+			replace(true);
+			t2.push_back(std::make_pair(key, value));
+			return;
+		}
+		if (t1.size() + b1.size() >= c) {
+			if (t1.size() < c) {
+				b1.pop_front();
+				replace(false);
+			} else {
+				t1.pop_front();
+			}
+		} else if (t1.size() + t2.size() + b1.size() + b2.size() >= c) {
+			if (t1.size() + t2.size() + b1.size() + b2.size() >= 2 * c) b2.pop_front();
+			replace(false);
+		}
+		t1.push_back(std::make_pair(key, value));
+	}
+
+	bool contains(int key) {
+		return locate(t1, key) != t1.end() || locate(t2, key) != t2.end();
+	}
+};
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// a key with a skewed distribution over [0, range)
+static int next_key(int range) {
+	unsigned r = next_rand();
+	if (r % 4 == 0) return (int)(next_rand() % (unsigned)range);
+	return (int)(next_rand() % (unsigned)(range / 8 + 1));
+}
+
+template<class Cache, class Reference>
+static void compare(const char *name, size_t capacity, int range, int operations) {
+	Cache cache(capacity);
+	Reference reference(capacity);
+	int hit_mismatches = 0, value_mismatches = 0, content_mismatches = 0;
+	for (int i = 0; i < operations; ++i) {
+		int key = next_key(range);
+		if (next_rand() % 3 == 0) {
+			cache.put(key, i);
+			reference.put(key, i);
+		} else {
+			int *a = cache.get(key);
+			int *b = reference.get(key);
+			if ((a == nullptr) != (b == nullptr)) ++hit_mismatches;
+			else if (a && *a != *b) ++value_mismatches;
+		}
+		if (i % 97 == 0) {
+			for (int k = 0; k < range; ++k) content_mismatches += cache.contains(k) != reference.contains(k);
+		}
+	}
+	sjtu::cache_stats stats = cache.stats();
+	printf("%-4s capacity %3d: hits %5d misses %5d evictions %5d size %3d | mismatches: hit %d value %d content %d\n",
+	       name, (int)capacity, (int)stats.hits, (int)stats.misses, (int)stats.evictions, (int)cache.size(),
+	       hit_mismatches, value_mismatches, content_mismatches);
+}
+
+template<class Cache, class Reference>
+static void compare_all(const char *name) {
+	const size_t capacities[] = {1, 2, 3, 8, 50};
+	for (size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); ++i) {
+		compare<Cache, Reference>(name, capacities[i], 400, 20000);
+	}
+}
+
+void test_scan_resistance() {
+	puts("Test: a scan does not flush 2Q and ARC");
+	sjtu::two_queue_cache<int, int> q(100);
+	sjtu::arc_cache<int, int> a(100);
+	sjtu::lru_cache<int, int> l(100);
+	for (int round = 0; round < 5; ++round) {
+		for (int k = 0; k < 50; ++k) {
+			if (!q.get(k)) q.put(k, k);
+			if (!a.get(k)) a.put(k, k);
+			if (!l.get(k)) l.put(k, k);
+		}
+	}
+	for (int k = 1000; k < 1500; ++k) {
+		q.put(k, k);
+		a.put(k, k);
+		l.put(k, k);
+	}
+	int in_q = 0, in_a = 0, in_l = 0;
+	for (int k = 0; k < 50; ++k) {
+		in_q += q.contains(k);
+		in_a += a.contains(k);
+		in_l += l.contains(k);
+	}
+	printf("hot keys left after the scan: lru %d, 2q %d, arc %d\n", in_l, in_q, in_a);
+}
+
+int main() {
+	puts("Test: eviction order against reference implementations");
+	compare_all<sjtu::lru_cache<int, int>, reference_lru>("lru");
+	compare_all<sjtu::lfu_cache<int, int>, reference_lfu>("lfu");
+	compare_all<sjtu::two_queue_cache<int, int>, reference_2q>("2q");
+	compare_all<sjtu::arc_cache<int, int>, reference_arc>("arc");
+	test_scan_resistance();
+	try {
+		sjtu::arc_cache<int, int> bad(0);
+	} catch (sjtu::runtime_error &) {
+		puts("capacity 0 throws");
+	}
+	return 0;
+}
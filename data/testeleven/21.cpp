@@ -0,0 +1,198 @@
+#include "split_linked_hashmap.hpp"
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+class Tracked {
+public:
+	static int copies, moves, defaults;
+	int val;
+	Tracked() : val(0) {
+		defaults++;
+	}
+	Tracked(int val) : val(val) {}
+	Tracked(int a, int b) : val(a * 100 + b) {}
+	Tracked(const Tracked &other) : val(other.val) {
+		copies++;
+	}
+	Tracked(Tracked &&other) noexcept : val(other.val) {
+		moves++;
+	}
+	Tracked & operator=(const Tracked &other) {
+		val = other.val;
+		copies++;
+		return *this;
+	}
+	Tracked & operator=(Tracked &&other) noexcept {
+		val = other.val;
+		moves++;
+		return *this;
+	}
+};
+int Tracked::copies = 0;
+int Tracked::moves = 0;
+int Tracked::defaults = 0;
+
+static void reset() {
+	Tracked::copies = Tracked::moves = Tracked::defaults = 0;
+}
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+void test_construction() {
+	puts("Test: values constructed in place");
+	sjtu::split_linked_hashmap<int, Tracked> map;
+	// keep growth of the slot arrays out of the counts
+	for (int i = 0; i < 8; ++i) map[i + 1000];
+	map.erase(1000);
+	map.erase(1001);
+
+	reset();
+	map[1].val = 5;
+	printf("operator[] on a new key: defaults %d copies %d moves %d\n", Tracked::defaults, Tracked::copies, Tracked::moves);
+	reset();
+	map[1].val = 6;
+	printf("operator[] on an existing key: defaults %d copies %d moves %d\n", Tracked::defaults, Tracked::copies,
+	       Tracked::moves);
+
+	reset();
+	sjtu::pair<const int, Tracked> entry(2, Tracked(2));
+	reset();
+	map.insert(std::move(entry));
+	printf("insert of an rvalue value_type: copies %d moves %d\n", Tracked::copies, Tracked::moves);
+
+	reset();
+	printf("try_emplace(3, 4, 5): inserted %d, ", (int)map.try_emplace(3, 4, 5).second);
+	printf("copies %d moves %d\n", Tracked::copies, Tracked::moves);
+	reset();
+	printf("try_emplace on an existing key: inserted %d, copies %d moves %d\n", (int)map.try_emplace(3, 9, 9).second,
+	       Tracked::copies, Tracked::moves);
+
+	for (sjtu::split_linked_hashmap<int, Tracked>::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		printf("%d -> %d\n", it->first, it->second.val);
+	}
+}
+
+void test_string_keys() {
+	puts("Test: moved keys");
+	sjtu::split_linked_hashmap<std::string, int> map;
+	std::string key = "a key long enough to live on the heap";
+	map[std::move(key)] = 1;
+	printf("key moved from: %s\n", key.empty() ? "yes" : "no");
+	key = "a key long enough to live on the heap";
+	map[std::move(key)] = 2;
+	printf("existing key left alone: %s, value %d\n", key.empty() ? "no" : "yes", map.at("a key long enough to live on the heap"));
+	std::string other = "another key long enough to live on the heap";
+	map.try_emplace(std::move(other), 3);
+	printf("try_emplace moved the key: %s, size %d\n", other.empty() ? "yes" : "no", (int)map.size());
+}
+
+void test_against_linked_hashmap() {
+	puts("Test: random operations against linked_hashmap");
+	sjtu::split_linked_hashmap<int, std::string> split;
+	sjtu::linked_hashmap<int, std::string> reference;
+	int erased = 0, missing = 0;
+	for (int i = 0; i < 60000; ++i) {
+		int key = (int)(next_rand() % 4000);
+		unsigned op = next_rand() % 4;
+		if (op == 0) {
+			size_t a = split.erase(key);
+			sjtu::linked_hashmap<int, std::string>::iterator it = reference.find(key);
+			size_t b = it == reference.end() ? 0 : 1;
+			if (b) reference.erase(it);
+			if (a != b) ++missing;
+			erased += (int)a;
+		} else if (op == 1) {
+			split[key] = std::to_string(i);
+			reference[key] = std::to_string(i);
+		} else if (op == 2) {
+			split.try_emplace(key, 3, 'x');
+			reference.try_emplace(key, 3, 'x');
+		} else {
+			split.insert(sjtu::pair<const int, std::string>(key, std::to_string(-i)));
+			reference.insert(sjtu::pair<const int, std::string>(key, std::to_string(-i)));
+		}
+	}
+	int mismatches = 0;
+	sjtu::linked_hashmap<int, std::string>::const_iterator ref = reference.cbegin();
+	for (sjtu::split_linked_hashmap<int, std::string>::const_iterator it = split.cbegin(); it != split.cend(); ++it, ++ref) {
+		if (ref == reference.cend() || it->first != ref->first || it->second != ref->second) ++mismatches;
+	}
+	printf("size %d / %d, erased %d, erase disagreements %d, order mismatches %d\n", (int)split.size(),
+	       (int)reference.size(), erased, missing, mismatches);
+
+	sjtu::split_linked_hashmap<int, std::string> copy(split);
+	copy.erase(copy.cbegin()->first);
+	printf("copy: size %d, original size %d\n", (int)copy.size(), (int)split.size());
+	printf("erase of a missing key: %d\n", (int)split.erase(-1));
+}
+
+// a key whose copy throws when armed
+struct touchy_key {
+	static bool armed;
+	int id;
+
+	explicit touchy_key(int id) : id(id) {}
+	touchy_key(const touchy_key &other) : id(other.id) {
+		if (armed) throw std::runtime_error("touchy");
+	}
+
+	bool operator==(const touchy_key &other) const {
+		return id == other.id;
+	}
+};
+bool touchy_key::armed = false;
+
+struct touchy_hash {
+	size_t operator()(const touchy_key &key) const {
+		return std::hash<int>()(key.id);
+	}
+};
+
+void test_self_reference() {
+	puts("Test: arguments referring into the map while it grows");
+	sjtu::split_linked_hashmap<int, std::string> map;
+	for (int i = 0; i < 16; ++i) map[i] = "value " + std::to_string(i) + " long enough to live on the heap";
+	// the slot arrays are full, so this insert moves them
+	map.try_emplace(100, map.at(3));
+	printf("try_emplace from an element: %s\n", map.at(100).c_str());
+	for (int i = 16; i < 32; ++i) map[i] = std::to_string(i);
+	map.insert(sjtu::pair<const int, std::string>(200, map.at(5)));
+	printf("insert from an element: %s, size %d\n", map.at(200).c_str(), (int)map.size());
+
+	sjtu::split_linked_hashmap<touchy_key, int, touchy_hash> touchy;
+	int thrown = 0;
+	for (int i = 0; i < 40; ++i) {
+		touchy_key key(i);
+		touchy_key::armed = i % 3 == 0;
+		try {
+			touchy.try_emplace(key, i);
+		} catch (std::runtime_error &) {
+			++thrown;
+		}
+	}
+	touchy_key::armed = false;
+	for (int i = 0; i < 40; i += 3) touchy.try_emplace(touchy_key(i), i);
+	int sum = 0, count = 0;
+	for (sjtu::split_linked_hashmap<touchy_key, int, touchy_hash>::const_iterator it = touchy.cbegin(); it != touchy.cend(); ++it) {
+		sum += it->second;
+		++count;
+	}
+	printf("throwing key copies: %d thrown, then size %d, elements %d, sum %d\n", thrown, (int)touchy.size(), count, sum);
+}
+
+int main() {
+	test_construction();
+	test_string_keys();
+	test_against_linked_hashmap();
+	test_self_reference();
+	return 0;
+}
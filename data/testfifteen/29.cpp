@@ -0,0 +1,117 @@
+#include "fast_hash.hpp"
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+static const char * yes_no(bool b) {
+	return b ? "yes" : "no";
+}
+
+// value at storage whose bytes were first all set to fill, so any
+// padding of T keeps that fill
+template<class T>
+static T * placed(unsigned char *storage, unsigned char fill, T value) {
+	std::memset(storage, fill, sizeof(T));
+	return new (storage) T(value);
+}
+
+template<class T>
+static void check_float(const char *name) {
+	sjtu::fast_hash<T> h;
+	alignas(T) unsigned char a[sizeof(T)], b[sizeof(T)];
+	T *x = placed<T>(a, 0x00, T(1.5));
+	T *y = placed<T>(b, 0xff, T(1.5));
+	printf("%s: -0 == +0 %s, padding ignored %s, 1.5 != 2.5 %s\n", name, yes_no(h(T(-0.0)) == h(T(0.0))),
+	       yes_no(h(*x) == h(*y)), yes_no(h(T(1.5)) != h(T(2.5))));
+}
+
+void test_floating_point() {
+	puts("Test: floating point");
+	check_float<float>("float");
+	check_float<double>("double");
+	check_float<long double>("long double");
+
+	sjtu::linked_hashmap<double, int, sjtu::fast_hash<double> > map;
+	map[0.0] = 1;
+	map[-0.0] = 2;
+	map[0.1] = 3;
+	printf("map: size %d, 0.0 -> %d, -0.0 found %s\n", (int)map.size(), map.at(0.0), yes_no(map.contains(-0.0)));
+
+	sjtu::linked_hashmap<long double, int, sjtu::fast_hash<long double> > wide;
+	alignas(long double) unsigned char a[sizeof(long double)], b[sizeof(long double)];
+	wide[*placed<long double>(a, 0x00, 3.25L)] = 7;
+	printf("long double key with other padding found %s\n", yes_no(wide.contains(*placed<long double>(b, 0xaa, 3.25L))));
+}
+
+void test_integers() {
+	puts("Test: integers");
+	sjtu::fast_hash<int> h;
+	sjtu::linked_hashmap<size_t, int> seen;
+	int collisions = 0;
+	for (int i = 0; i < 100000; ++i) {
+		if (!seen.try_emplace(h(i), i).second) ++collisions;
+	}
+	printf("distinct hashes of 100000 ints: %d, collisions %d\n", (int)seen.size(), collisions);
+	enum color { red, green };
+	printf("enum: %s, pointer stable %s\n", yes_no(sjtu::fast_hash<color>()(green) == sjtu::fast_hash<color>()(green)),
+	       yes_no(sjtu::fast_hash<int *>()(&collisions) == sjtu::fast_hash<int *>()(&collisions)));
+}
+
+void test_strings() {
+	puts("Test: strings");
+	sjtu::fast_hash<std::string> hs;
+	sjtu::fast_hash<std::string_view> hv;
+	int mismatches = 0, collisions = 0;
+	sjtu::linked_hashmap<size_t, int> seen;
+	std::string s;
+	for (int len = 0; len < 200; ++len) {
+		if (hs(s) != hv(std::string_view(s))) ++mismatches;
+		if (!seen.try_emplace(hs(s), len).second) ++collisions;
+		s += (char)('a' + len % 26);
+	}
+	// every byte counts, at every length class
+	for (size_t len = 1; len < 100; len += 7) {
+		std::string base(len, 'x');
+		for (size_t i = 0; i < len; ++i) {
+			std::string other = base;
+			other[i] = 'y';
+			if (hs(other) == hs(base)) ++collisions;
+		}
+	}
+	printf("string == string_view %s, collisions %d\n", yes_no(mismatches == 0), collisions);
+
+	sjtu::linked_hashmap<std::string, int, sjtu::fast_hash<std::string> > map;
+	for (int i = 0; i < 5000; ++i) map["key" + std::to_string(i)] = i;
+	long long sum = 0;
+	for (int i = 0; i < 5000; i += 7) sum += map.at("key" + std::to_string(i));
+	printf("map lookups: sum %lld\n", sum);
+}
+
+void test_composites() {
+	puts("Test: pairs and tuples");
+	sjtu::fast_hash<std::pair<int, std::string> > hp;
+	sjtu::fast_hash<sjtu::pair<int, std::string> > hq;
+	sjtu::fast_hash<std::tuple<int, int, int> > ht;
+	printf("std::pair == sjtu::pair %s\n", yes_no(hp(std::make_pair(1, std::string("a"))) ==
+	                                             hq(sjtu::pair<int, std::string>(1, std::string("a")))));
+	printf("order matters: pair %s, tuple %s\n", yes_no(hp(std::make_pair(1, std::string("2"))) != hp(std::make_pair(2, std::string("1")))),
+	       yes_no(ht(std::make_tuple(1, 2, 3)) != ht(std::make_tuple(3, 2, 1))));
+	sjtu::linked_hashmap<std::tuple<int, int, int>, int, sjtu::fast_hash<std::tuple<int, int, int> > > grid;
+	for (int x = 0; x < 20; ++x)
+		for (int y = 0; y < 20; ++y)
+			for (int z = 0; z < 20; ++z) grid[std::make_tuple(x, y, z)] = x * 400 + y * 20 + z;
+	printf("grid: size %d, (3, 4, 5) -> %d\n", (int)grid.size(), grid.at(std::make_tuple(3, 4, 5)));
+}
+
+int main() {
+	test_floating_point();
+	test_integers();
+	test_strings();
+	test_composites();
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <string>
+
+typedef sjtu::linked_hashmap<int, std::string> map_type;
+
+void test_lookups() {
+	puts("Test: find_ptr, get_or and contains");
+	map_type map;
+	for (int i = 0; i < 1000; ++i) map[i * 3] = std::to_string(i);
+	int hits = 0, pointer_hits = 0, fallbacks = 0, wrong = 0;
+	for (int k = -10; k < 3100; ++k) {
+		bool present = k >= 0 && k % 3 == 0 && k < 3000;
+		hits += map.contains(k);
+		std::string *p = map.find_ptr(k);
+		pointer_hits += p != nullptr;
+		std::string v = map.get_or(k, "none");
+		fallbacks += v == "none";
+		if (present != map.contains(k) || present != (p != nullptr)) ++wrong;
+		if (present && (*p != std::to_string(k / 3) || v != *p || p != &map.at(k))) ++wrong;
+	}
+	printf("contains %d, find_ptr %d, fallbacks %d, wrong %d\n", hits, pointer_hits, fallbacks, wrong);
+}
+
+void test_pointer_writes() {
+	puts("Test: writes through find_ptr");
+	map_type map;
+	map[1] = "one";
+	map[2] = "two";
+	*map.find_ptr(2) = "deux";
+	printf("2 -> %s\n", map.at(2).c_str());
+	// the pointer stays valid while the map grows
+	std::string *p = map.find_ptr(1);
+	for (int i = 10; i < 5000; ++i) map[i] = "x";
+	*p += "!";
+	printf("1 -> %s\n", map.at(1).c_str());
+	map.erase(map.find(1));
+	printf("after erase: find_ptr %s, contains %d, get_or %s\n", map.find_ptr(1) ? "found" : "null", (int)map.contains(1),
+	       map.get_or(1, "gone").c_str());
+}
+
+void test_const() {
+	puts("Test: const map");
+	map_type map;
+	map[7] = "seven";
+	const map_type &view = map;
+	const std::string *p = view.find_ptr(7);
+	printf("%s %s %d %d\n", p ? p->c_str() : "null", view.get_or(8, "eight?").c_str(), (int)view.contains(7),
+	       (int)view.contains(8));
+	map_type empty;
+	printf("empty: %s %d\n", empty.find_ptr(0) ? "found" : "null", (int)empty.contains(0));
+}
+
+void test_filter() {
+	puts("Test: with the miss filter");
+	map_type map;
+	map.enable_miss_filter();
+	for (int i = 0; i < 20000; ++i) map[i] = "v";
+	for (int i = 0; i < 20000; i += 2) map.erase(map.find(i));
+	int wrong = 0;
+	for (int i = 0; i < 40000; ++i) {
+		bool present = i < 20000 && i % 2 == 1;
+		if (map.contains(i) != present || (map.find_ptr(i) != nullptr) != present) ++wrong;
+	}
+	printf("wrong %d\n", wrong);
+}
+
+int main() {
+	test_lookups();
+	test_pointer_writes();
+	test_const();
+	test_filter();
+	return 0;
+}
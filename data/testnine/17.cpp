@@ -0,0 +1,121 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <utility>
+
+typedef sjtu::linked_hashmap<int, long long> map_type;
+// a polynomial hash of a sequence and the power of its length:
+// associative, but not commutative, so it sees the order of the elements
+typedef std::pair<unsigned long long, unsigned long long> digest;
+
+static digest combine(const digest &a, const digest &b) {
+	return digest(a.first * b.second + b.first, a.second * b.second);
+}
+
+static digest digest_of(const map_type::value_type &e) {
+	return digest((unsigned long long)e.first * 1000003ull + (unsigned long long)e.second, 131ull);
+}
+
+static digest sequential_digest(const map_type &map) {
+	digest d(0, 1);
+	for (map_type::const_iterator it = map.cbegin(); it != map.cend(); ++it) d = combine(d, digest_of(*it));
+	return d;
+}
+
+// a map whose order list has seen erases, re-inserts and moves
+static void build(map_type &map, int n) {
+	for (int i = 0; i < n; ++i) map[i * 3] = i;
+	for (int i = 0; i < n; i += 5) map.erase(map.find(i * 3));
+	for (int i = 0; i < n; i += 7) map[i * 3 + 1] = -i;
+	for (int i = 1; i < n; i += 11) {
+		map_type::iterator it = map.find(i * 3);
+		if (it != map.end()) map.move_to_front(it);
+	}
+}
+
+void test_reduce() {
+	puts("Test: parallel_reduce");
+	map_type map;
+	build(map, 200000);
+	digest expected = sequential_digest(map);
+	printf("size %d\n", (int)map.size());
+	for (size_t threads = 1; threads <= 8; threads *= 2) {
+		sjtu::thread_pool pool(threads);
+		digest d = map.parallel_reduce(digest(0, 1), digest_of, combine, pool);
+		printf("%d threads: matches sequential %s\n", (int)threads, d == expected ? "yes" : "no");
+	}
+	sjtu::thread_pool pool(4);
+	map_type empty;
+	digest d = empty.parallel_reduce(digest(5, 1), digest_of, combine, pool);
+	printf("empty map: %llu\n", d.first);
+}
+
+void test_for_each() {
+	puts("Test: parallel_for_each");
+	map_type map;
+	build(map, 100000);
+	sjtu::thread_pool pool(4);
+	map.parallel_for_each([](map_type::value_type &e) { e.second = e.second * 2 + e.first; }, pool);
+	long long bad = 0, position = 0;
+	map_type reference;
+	build(reference, 100000);
+	map_type::const_iterator it = map.cbegin();
+	for (map_type::const_iterator ref = reference.cbegin(); ref != reference.cend(); ++ref, ++it, ++position) {
+		if (it->first != ref->first || it->second != ref->second * 2 + ref->first) ++bad;
+	}
+	printf("visited %lld, wrong %lld\n", position, bad);
+}
+
+void test_filter() {
+	puts("Test: parallel_filter_into");
+	map_type map;
+	build(map, 100000);
+	map_type expected;
+	for (map_type::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		if (it->second % 3 == 0) expected.insert(*it);
+	}
+	for (size_t threads = 1; threads <= 8; threads *= 2) {
+		sjtu::thread_pool pool(threads);
+		map_type out;
+		map.parallel_filter_into(out, [](const map_type::value_type &e) { return e.second % 3 == 0; }, pool);
+		printf("%d threads: %d matches, same order %s\n", (int)threads, (int)out.size(),
+		       sequential_digest(out) == sequential_digest(expected) ? "yes" : "no");
+	}
+}
+
+void test_concurrent_const_calls() {
+	puts("Test: const parallel calls from several threads at once");
+	map_type map;
+	build(map, 100000);
+	digest expected = sequential_digest(map);
+	int wrong = 0;
+	for (int round = 0; round < 5; ++round) {
+		// erasing a split point leaves the splits for the callers to rebuild
+		map.erase(map.begin());
+		for (int i = 0; i < 20; ++i) {
+			map_type::iterator it = map.find(i * 4096 * 3);
+			if (it != map.end()) map.erase(it);
+		}
+		expected = sequential_digest(map);
+		std::vector<digest> results(4);
+		std::vector<std::thread> callers;
+		for (size_t t = 0; t < results.size(); ++t) {
+			callers.emplace_back([&map, &results, t] {
+				sjtu::thread_pool pool(2);
+				results[t] = map.parallel_reduce(digest(0, 1), digest_of, combine, pool);
+			});
+		}
+		for (size_t t = 0; t < callers.size(); ++t) callers[t].join();
+		for (size_t t = 0; t < results.size(); ++t) wrong += results[t] != expected;
+	}
+	printf("results differing from sequential: %d\n", wrong);
+}
+
+int main() {
+	test_reduce();
+	test_for_each();
+	test_filter();
+	test_concurrent_const_calls();
+	return 0;
+}
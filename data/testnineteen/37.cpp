@@ -0,0 +1,91 @@
+#include "cache.hpp"
+#include "frequency_sketch.hpp"
+#include <cstdio>
+
+void test_sketch() {
+	puts("Test: frequency sketch");
+	sjtu::detail::frequency_sketch sketch;
+	printf("empty before reset: %d\n", (int)sketch.empty());
+	sketch.reset(1000);
+	std::hash<int> hasher;
+	// the estimate never falls below the true count
+	int under = 0;
+	for (int k = 0; k < 500; ++k) {
+		for (int j = 0; j < k % 8; ++j) sketch.add(hasher(k));
+	}
+	for (int k = 0; k < 500; ++k) under += sketch.estimate(hasher(k)) < (unsigned)(k % 8);
+	printf("estimates below the true count: %d\n", under);
+	for (int j = 0; j < 40; ++j) sketch.add(hasher(7777));
+	printf("saturates at %u\n", sketch.estimate(hasher(7777)));
+	// 10 * 1000 additions age the sketch and halve every count
+	unsigned before = sketch.estimate(hasher(7777));
+	for (int k = 0; k < 10000; ++k) sketch.add(hasher(100000 + k));
+	unsigned after = sketch.estimate(hasher(7777));
+	printf("aged: %d\n", (int)(after < before && after >= before / 2 - 1));
+	sketch.release();
+	printf("empty after release: %d\n", (int)sketch.empty());
+}
+
+void test_scan() {
+	puts("Test: admission keeps a scan out");
+	sjtu::lru_cache<int, int> plain(100), filtered(100);
+	filtered.enable_admission();
+	for (int round = 0; round < 4; ++round) {
+		for (int k = 0; k < 100; ++k) {
+			if (!plain.get(k)) plain.put(k, k);
+			if (!filtered.get(k)) filtered.put(k, k);
+		}
+	}
+	for (int k = 1000; k < 3000; ++k) {
+		plain.put(k, k);
+		filtered.put(k, k);
+	}
+	int hot_plain = 0, hot_filtered = 0;
+	for (int k = 0; k < 100; ++k) {
+		hot_plain += plain.contains(k);
+		hot_filtered += filtered.contains(k);
+	}
+	printf("hot keys kept: without %d, with %d\n", hot_plain, hot_filtered);
+	printf("rejections: without %d, with %d\n", (int)plain.stats().rejections, (int)filtered.stats().rejections);
+	printf("size %d\n", (int)filtered.size());
+}
+
+void test_frequent_newcomer() {
+	puts("Test: a frequent new key is admitted");
+	sjtu::lru_cache<int, int> cache(10);
+	cache.enable_admission(100);
+	for (int k = 0; k < 10; ++k) cache.put(k, k);
+	// requested often while absent, so it beats the least recent entry
+	for (int j = 0; j < 5; ++j) cache.get(500);
+	cache.put(500, 500);
+	printf("admitted %d, evicted 0: %d, rejections %d\n", (int)cache.contains(500), (int)!cache.contains(0),
+	       (int)cache.stats().rejections);
+	// a key seen once is not
+	cache.put(600, 600);
+	printf("admitted once-seen key: %d, rejections %d\n", (int)cache.contains(600),
+	       (int)cache.stats().rejections);
+}
+
+void test_updates_and_room() {
+	puts("Test: updates and free room bypass admission");
+	sjtu::lru_cache<int, int> cache(4);
+	cache.enable_admission();
+	for (int k = 0; k < 4; ++k) cache.put(k, k);
+	printf("filled below capacity: size %d, rejections %d\n", (int)cache.size(), (int)cache.stats().rejections);
+	cache.put(2, 20);
+	printf("updated in place: %d\n", *cache.get(2));
+	cache.put(9, 9);
+	printf("new key when full: contains %d, rejections %d\n", (int)cache.contains(9),
+	       (int)cache.stats().rejections);
+	cache.disable_admission();
+	cache.put(9, 9);
+	printf("after disable: contains %d, size %d\n", (int)cache.contains(9), (int)cache.size());
+}
+
+int main() {
+	test_sketch();
+	test_scan();
+	test_frequent_newcomer();
+	test_updates_and_room();
+	return 0;
+}
@@ -0,0 +1,148 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <tuple>
+#include <utility>
+
+// every heap allocation of the program is counted
+static long allocations = 0;
+
+void * operator new(std::size_t size) {
+	++allocations;
+	void *p = std::malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept {
+	std::free(p);
+}
+
+class Tracked {
+public:
+	static int copies, moves;
+	int val;
+	Tracked() : val(0) {}
+	Tracked(int val) : val(val) {}
+	Tracked(const Tracked &other) : val(other.val) {
+		copies++;
+	}
+	Tracked(Tracked &&other) : val(other.val) {
+		moves++;
+	}
+	Tracked & operator=(const Tracked &other) {
+		val = other.val;
+		copies++;
+		return *this;
+	}
+	Tracked & operator=(Tracked &&other) {
+		val = other.val;
+		moves++;
+		return *this;
+	}
+};
+int Tracked::copies = 0;
+int Tracked::moves = 0;
+
+// long enough to live on the heap, so every copy allocates
+static std::string long_string(int i) {
+	return "a string well past the small buffer #" + std::to_string(i);
+}
+
+typedef sjtu::linked_hashmap<std::string, std::string> string_map;
+
+// allocations made by fn, with the map's slabs and table already in place
+template<class F>
+static long count_allocations(F fn) {
+	long before = allocations;
+	fn();
+	return allocations - before;
+}
+
+void test_pair() {
+	puts("Test: pair");
+	Tracked::copies = Tracked::moves = 0;
+	Tracked a(1), b(2);
+	sjtu::pair<Tracked, Tracked> p(std::move(a), std::move(b));
+	printf("forwarding ctor: copies %d moves %d\n", Tracked::copies, Tracked::moves);
+
+	Tracked::copies = Tracked::moves = 0;
+	sjtu::pair<const Tracked, Tracked> q(std::move(p));
+	printf("converting move: copies %d moves %d\n", Tracked::copies, Tracked::moves);
+
+	Tracked::copies = Tracked::moves = 0;
+	sjtu::pair<Tracked, std::string> r(std::piecewise_construct, std::forward_as_tuple(7), std::forward_as_tuple(3, 'x'));
+	printf("piecewise: %d %s copies %d moves %d\n", r.first.val, r.second.c_str(), Tracked::copies, Tracked::moves);
+}
+
+void test_strings() {
+	puts("Test: string allocations");
+	string_map map;
+	map.reserve(64);
+	// make the first slab exist
+	map[long_string(-1)] = long_string(-1);
+
+	std::string key = long_string(0), value = long_string(0);
+	long n = count_allocations([&] { map[std::move(key)] = std::move(value); });
+	printf("operator[] with temporaries: %ld allocations\n", n);
+
+	key = long_string(1);
+	value = long_string(1);
+	n = count_allocations([&] { map.emplace(std::move(key), std::move(value)); });
+	printf("emplace with temporaries: %ld allocations\n", n);
+
+	key = long_string(2);
+	n = count_allocations([&] { map.emplace(std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(5, 'y')); });
+	printf("piecewise emplace: %ld allocations\n", n);
+
+	string_map::value_type entry(long_string(3), long_string(3));
+	n = count_allocations([&] { map.insert(std::move(entry)); });
+	printf("insert of an rvalue value_type: %ld allocations (the const key)\n", n);
+
+	string_map::value_type again(long_string(3), long_string(4));
+	n = count_allocations([&] { map.insert(again); });
+	printf("insert of an existing key: %ld allocations\n", n);
+
+	key = long_string(0);
+	value = long_string(9);
+	n = count_allocations([&] { map.emplace(std::move(key), std::move(value)); });
+	printf("emplace of an existing key: %ld allocations, value %s\n", n, map.at(long_string(0)).c_str());
+
+	printf("size %d\n", (int)map.size());
+	for (string_map::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		printf("%s -> %s\n", it->first.c_str(), it->second.c_str());
+	}
+}
+
+void test_tracked() {
+	puts("Test: copies through the map");
+	sjtu::linked_hashmap<int, Tracked> map;
+	map.reserve(16);
+	map[0] = Tracked(0);
+	Tracked::copies = Tracked::moves = 0;
+	map[1] = Tracked(1);
+	printf("operator[] = temporary: copies %d moves %d\n", Tracked::copies, Tracked::moves);
+
+	Tracked::copies = Tracked::moves = 0;
+	map.insert(sjtu::pair<const int, Tracked>(2, Tracked(2)));
+	printf("insert temporary pair: copies %d moves %d\n", Tracked::copies, Tracked::moves);
+
+	Tracked::copies = Tracked::moves = 0;
+	map.emplace(3, 3);
+	printf("emplace from arguments: copies %d moves %d\n", Tracked::copies, Tracked::moves);
+
+	Tracked::copies = Tracked::moves = 0;
+	sjtu::linked_hashmap<int, Tracked> copy(map);
+	printf("copy of %d elements: copies %d moves %d\n", (int)copy.size(), Tracked::copies, Tracked::moves);
+}
+
+int main() {
+	test_pair();
+	test_strings();
+	test_tracked();
+	return 0;
+}
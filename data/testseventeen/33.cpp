@@ -0,0 +1,83 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+static long hash_calls = 0, equal_calls = 0;
+
+// hashes keys to one of few values, and counts its calls
+class CountingHash {
+public:
+	size_t operator()(int key) const {
+		++hash_calls;
+		return (size_t)(key % 64) * 0x9e3779b97f4a7c15ull;
+	}
+};
+
+class CountingEqual {
+public:
+	bool operator()(int a, int b) const {
+		++equal_calls;
+		return a == b;
+	}
+};
+
+typedef sjtu::linked_hashmap<int, int, CountingHash, CountingEqual> map_type;
+
+static void reset() {
+	hash_calls = equal_calls = 0;
+}
+
+void test_equal_calls() {
+	puts("Test: the cached hash is compared before the key");
+	// one bucket holds keys of many hash values
+	sjtu::linked_hashmap<int, int, CountingHash, CountingEqual, sjtu::prime_index> map;
+	map.rehash(29);
+	for (int i = 0; i < 640; ++i) map[i] = i;
+	reset();
+	long long sum = 0;
+	for (int i = 0; i < 640; ++i) sum += map.at(i);
+	// without the hash check a hit would compare ~11 keys of its chain
+	printf("640 hits: sum %lld, hash calls %ld, equal calls %ld\n", sum, hash_calls, equal_calls);
+	reset();
+	int found = 0;
+	for (int i = 640; i < 1280; ++i) found += map.count(i);
+	printf("640 misses: found %d, hash calls %ld, equal calls %ld\n", found, hash_calls, equal_calls);
+}
+
+void test_no_rehashing_of_keys() {
+	puts("Test: keys are hashed once");
+	map_type map;
+	reset();
+	for (int i = 0; i < 20000; ++i) map[i] = i;
+	printf("20000 inserts through growth: hash calls %ld\n", hash_calls);
+	reset();
+	map.rehash(map.bucket_count() * 3);
+	map.reserve(100000);
+	printf("rehash and reserve: hash calls %ld\n", hash_calls);
+	reset();
+	map_type::iterator it = map.find(5);
+	map.erase(it);
+	for (int k = 0; k < 100; ++k) map.erase(map.begin());
+	map.trim_front(1000);
+	map.pop_back();
+	printf("erases: hash calls %ld\n", hash_calls);
+	reset();
+	map_type copy(map);
+	printf("copy of %d elements: hash calls %ld\n", (int)copy.size(), hash_calls);
+	reset();
+	copy.clear();
+	printf("clear: hash calls %ld\n", hash_calls);
+	int wrong = 0;
+	for (int i = 0; i < 20000; ++i) {
+		bool present = i >= 1101 && i < 19999;
+		if (map.contains(i) != present) ++wrong;
+	}
+	printf("contents after all that: wrong %d\n", wrong);
+}
+
+int main() {
+	test_equal_calls();
+	test_no_rehashing_of_keys();
+	return 0;
+}
@@ -0,0 +1,148 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+typedef sjtu::linked_hashmap<int, int> map_type;
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// every single-key lookup of filtered must agree with reference
+static int disagreements(const map_type &filtered, const map_type &reference, int range) {
+	int wrong = 0;
+	for (int k = -range; k < 2 * range; ++k) {
+		bool present = reference.count(k) != 0;
+		if ((filtered.count(k) != 0) != present) ++wrong;
+		if ((filtered.find(k) != filtered.cend()) != present) ++wrong;
+		if (filtered.contains(k) != present) ++wrong;
+		if ((filtered.find_ptr(k) != nullptr) != present) ++wrong;
+		if (present && filtered.at(k) != reference.at(k)) ++wrong;
+	}
+	return wrong;
+}
+
+static void print_stats(const char *when, const map_type &map) {
+	map_type::miss_filter_stats stats = map.filter_stats();
+	printf("%s: size %d, enabled %d, keys %d, erased %d, covers the size %s\n", when, (int)map.size(),
+	       (int)stats.enabled, (int)stats.keys, (int)stats.erased, stats.bits >= 8 * map.size() ? "yes" : "no");
+}
+
+void test_random_operations() {
+	puts("Test: filter under insert, erase and rehash");
+	map_type filtered, reference;
+	filtered.enable_miss_filter();
+	const int range = 20000;
+	for (int round = 0; round < 8; ++round) {
+		for (int i = 0; i < 6000; ++i) {
+			int key = (int)(next_rand() % range);
+			switch (next_rand() % 5) {
+			case 0:
+			case 1:
+				filtered[key] = i;
+				reference[key] = i;
+				break;
+			case 2: {
+				map_type::iterator it = filtered.find(key);
+				if (it != filtered.end()) filtered.erase(it);
+				map_type::iterator jt = reference.find(key);
+				if (jt != reference.end()) reference.erase(jt);
+				break;
+			}
+			case 3:
+				filtered.insert(map_type::value_type(key, -i));
+				reference.insert(map_type::value_type(key, -i));
+				break;
+			default:
+				filtered.try_emplace(key, i);
+				reference.try_emplace(key, i);
+				break;
+			}
+		}
+		if (round == 2) {
+			filtered.rehash(filtered.bucket_count() * 4);
+			puts("rehashed to four times the buckets");
+		}
+		if (round == 4) {
+			filtered.trim_front(filtered.size() / 2);
+			reference.trim_front(reference.size() / 2);
+			puts("trimmed half from the front");
+		}
+		if (round == 6) {
+			filtered.pop_front();
+			filtered.pop_back();
+			reference.pop_front();
+			reference.pop_back();
+			puts("popped both ends");
+		}
+		printf("round %d: wrong %d\n", round, disagreements(filtered, reference, range));
+		print_stats("  filter", filtered);
+	}
+}
+
+void test_erase_rebuild() {
+	puts("Test: erased keys trigger a rebuild");
+	map_type map;
+	map.enable_miss_filter();
+	for (int i = 0; i < 1000; ++i) map[i] = i;
+	for (int i = 0; i < 1000; i += 2) map.erase(map.find(i));
+	print_stats("half erased", map);
+	map.erase(map.find(1));
+	print_stats("one more", map);
+	for (int i = 3; i < 1000; i += 2) map.erase(map.find(i));
+	print_stats("all erased", map);
+	map[5] = 5;
+	printf("after reinsert: contains 5 %d, contains 4 %d\n", (int)map.contains(5), (int)map.contains(4));
+}
+
+void test_toggle() {
+	puts("Test: enable, disable, clear and copy");
+	map_type map, reference;
+	for (int i = 0; i < 3000; ++i) {
+		map[i * 5] = i;
+		reference[i * 5] = i;
+	}
+	map.enable_miss_filter(8);
+	printf("enabled late: wrong %d\n", disagreements(map, reference, 15000));
+	map_type copy(map);
+	print_stats("copy", copy);
+	printf("copy: wrong %d\n", disagreements(copy, reference, 15000));
+	map.disable_miss_filter();
+	print_stats("disabled", map);
+	printf("disabled: wrong %d\n", disagreements(map, reference, 15000));
+	map_type assigned;
+	assigned = copy;
+	print_stats("assigned from filtered", assigned);
+	printf("assigned: wrong %d\n", disagreements(assigned, reference, 15000));
+	assigned.enable_miss_filter(16);
+	assigned = map;
+	print_stats("assigned from unfiltered", assigned);
+	printf("assigned: wrong %d\n", disagreements(assigned, reference, 15000));
+	copy.clear();
+	print_stats("cleared copy", copy);
+	copy[1] = 1;
+	printf("cleared copy: contains 1 %d, contains 5 %d\n", (int)copy.contains(1), (int)copy.contains(5));
+
+	std::vector<std::pair<int, int> > rows;
+	for (int i = 0; i < 100000; ++i) rows.push_back(std::make_pair(i * 3, i));
+	sjtu::thread_pool pool(4);
+	map_type bulk;
+	bulk.enable_miss_filter();
+	bulk.bulk_insert(rows.begin(), rows.end(), &pool);
+	int wrong = 0;
+	for (int k = 0; k < 300000; ++k) wrong += bulk.contains(k) != (k % 3 == 0);
+	printf("after a parallel bulk_insert: wrong %d\n", wrong);
+	print_stats("bulk", bulk);
+}
+
+int main() {
+	test_random_operations();
+	test_erase_rebuild();
+	test_toggle();
+	return 0;
+}
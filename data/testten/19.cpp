@@ -0,0 +1,85 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+
+typedef sjtu::linked_hashmap<int, int> map_type;
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// the aggregates, recomputed by walking the list
+static void print_reference(const map_type &map) {
+	long long sum = 0;
+	int lo = 0, hi = 0;
+	size_t odd = 0;
+	bool first = true;
+	for (map_type::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		sum += it->second;
+		if (first || it->second < lo) lo = it->second;
+		if (first || it->second > hi) hi = it->second;
+		odd += it->second % 2 != 0;
+		first = false;
+	}
+	printf("  walk:       sum %lld min %d max %d odd %d\n", sum, lo, hi, (int)odd);
+}
+
+static void print_aggregates(const map_type &map) {
+	size_t calls = 0;
+	size_t odd = map.count_values_if([&calls](int v) {
+		++calls;
+		return v % 2 != 0;
+	});
+	printf("  aggregates: sum %lld min %d max %d odd %d\n", map.sum_values<long long>(), map.min_value(),
+	       map.max_value(), (int)odd);
+	printf("  predicate calls %d for %d elements\n", (int)calls, (int)map.size());
+}
+
+void test_interleaved() {
+	puts("Test: aggregates after interleaved erase and insert");
+	map_type map;
+	for (int round = 0; round < 6; ++round) {
+		for (int i = 0; i < 3000; ++i) {
+			int key = (int)(next_rand() % 5000);
+			int value = (int)(next_rand() % 20001) - 10000;
+			map_type::iterator it = map.find(key);
+			if (next_rand() % 3 == 0) {
+				if (it != map.end()) map.erase(it);
+			} else {
+				map[key] = value;
+			}
+		}
+		printf("round %d, size %d\n", round, (int)map.size());
+		print_reference(map);
+		print_aggregates(map);
+	}
+}
+
+void test_edges() {
+	puts("Test: edge cases");
+	map_type map;
+	printf("empty sum %lld, count %d\n", map.sum_values<long long>(), (int)map.count_values_if([](int) { return true; }));
+	try {
+		map.min_value();
+	} catch (sjtu::container_is_empty &) {
+		puts("min_value of an empty map throws");
+	}
+	for (int i = 0; i < 100; ++i) map[i] = -i - 1;
+	for (int i = 0; i < 100; ++i) {
+		if (i != 42) map.erase(map.find(i));
+	}
+	// the only live value is negative; erased slots must not read as zero
+	printf("single element: sum %lld min %d max %d\n", map.sum_values<long long>(), map.min_value(), map.max_value());
+	map.clear();
+	map[7] = 3;
+	printf("after clear: sum %lld min %d max %d\n", map.sum_values<long long>(), map.min_value(), map.max_value());
+}
+
+int main() {
+	test_interleaved();
+	test_edges();
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <string>
+
+// counts live objects, to check every entry is destroyed exactly once
+class Counted {
+public:
+	static int alive, destroyed;
+	int val;
+	Counted(int val = 0) : val(val) {
+		alive++;
+	}
+	Counted(const Counted &other) : val(other.val) {
+		alive++;
+	}
+	Counted & operator=(const Counted &other) {
+		val = other.val;
+		return *this;
+	}
+	~Counted() {
+		alive--;
+		destroyed++;
+	}
+};
+int Counted::alive = 0;
+int Counted::destroyed = 0;
+
+class CountedHash {
+public:
+	size_t operator()(const Counted &c) const {
+		return std::hash<int>()(c.val);
+	}
+};
+
+class CountedEqual {
+public:
+	bool operator()(const Counted &a, const Counted &b) const {
+		return a.val == b.val;
+	}
+};
+
+typedef sjtu::linked_hashmap<Counted, Counted, CountedHash, CountedEqual> counted_map;
+
+void test_destruction() {
+	puts("Test: destruction");
+	{
+		counted_map map;
+		for (int i = 0; i < 10000; ++i) map[Counted(i)] = Counted(-i);
+		for (int i = 0; i < 10000; i += 4) map.erase(map.find(Counted(i)));
+		Counted::destroyed = 0;
+		printf("size %d, alive %d\n", (int)map.size(), Counted::alive);
+	}
+	printf("after destruction: alive %d, destroyed %d\n", Counted::alive, Counted::destroyed);
+}
+
+void test_clear() {
+	puts("Test: clear and reuse");
+	counted_map map;
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 5000 * (round + 1); ++i) map[Counted(i)] = Counted(i + round);
+		for (int i = 0; i < 5000; i += 3) map.erase(map.find(Counted(i)));
+		long long sum = 0;
+		int found = 0;
+		for (int i = 0; i < 5000 * (round + 1); ++i) {
+			counted_map::iterator it = map.find(Counted(i));
+			if (it != map.end()) {
+				sum += it->second.val;
+				++found;
+			}
+		}
+		printf("round %d: size %d, found %d, sum %lld, alive %d\n", round, (int)map.size(), found, sum, Counted::alive);
+		map.clear();
+		printf("after clear: size %d, alive %d, begin == end %s\n", (int)map.size(), Counted::alive,
+		       map.begin() == map.end() ? "yes" : "no");
+	}
+}
+
+void test_trivial() {
+	puts("Test: trivially destructible entries");
+	sjtu::linked_hashmap<long long, long long> map;
+	for (long long i = 0; i < 100000; ++i) map[i * 11] = i;
+	map.clear();
+	printf("after clear: size %d, find %s\n", (int)map.size(), map.find(11) == map.end() ? "missing" : "found");
+	for (long long i = 0; i < 1000; ++i) map[i] = i;
+	long long sum = 0;
+	for (sjtu::linked_hashmap<long long, long long>::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		sum += it->second;
+	}
+	printf("refilled: size %d, sum %lld\n", (int)map.size(), sum);
+}
+
+void test_strings() {
+	puts("Test: strings");
+	sjtu::linked_hashmap<std::string, std::string> map;
+	for (int i = 0; i < 3000; ++i) map["key number " + std::to_string(i) + " long enough for the heap"] = std::to_string(i);
+	map.clear();
+	map["again"] = "value";
+	sjtu::linked_hashmap<std::string, std::string> copy(map);
+	printf("size %d, copy %s -> %s\n", (int)copy.size(), copy.cbegin()->first.c_str(), copy.cbegin()->second.c_str());
+}
+
+int main() {
+	test_destruction();
+	test_clear();
+	test_trivial();
+	test_strings();
+	return 0;
+}
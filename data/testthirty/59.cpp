@@ -0,0 +1,110 @@
+#include "linked_hashmap.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+static unsigned long long state = 2463534242ull;
+static unsigned long long next_rand() {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// the same random inserts, erases, lookups and reserves under an index
+// policy; returns a digest of the lookups and of the final order
+template<class Key, class Policy, class Make>
+static unsigned long long run(Make make, size_t &buckets, size_t &size) {
+	typedef sjtu::linked_hashmap<Key, int, std::hash<Key>, std::equal_to<Key>, Policy> map_type;
+	map_type map;
+	unsigned long long saved = state, digest = 0;
+	state = 12345;
+	for (int i = 0; i < 60000; ++i) {
+		Key key = make((int)(next_rand() % 20000));
+		unsigned op = (unsigned)(next_rand() % 8);
+		if (op < 4) {
+			map[key] = i;
+		} else if (op < 6) {
+			typename map_type::iterator it = map.find(key);
+			if (it != map.end()) map.erase(it);
+		} else {
+			const int *found = map.find_ptr(key);
+			digest = digest * 31 + (found ? (unsigned long long)*found + 1 : 0);
+		}
+		if (i % 5000 == 7) map.reserve(map.size() * 3);
+	}
+	// batched lookups go through the policy's index_integers()
+	std::vector<Key> probes;
+	for (int i = 0; i < 1000; ++i) probes.push_back(make(i * 17 % 20000));
+	std::vector<const typename map_type::value_type *> found(probes.size());
+	map.find_batch(probes.data(), probes.size(), found.data());
+	for (size_t i = 0; i < found.size(); ++i) digest = digest * 31 + (found[i] ? (unsigned long long)found[i]->second + 1 : 0);
+	for (typename map_type::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		digest = digest * 131 + (unsigned long long)it->second;
+	}
+	buckets = map.bucket_count();
+	size = map.size();
+	state = saved;
+	return digest;
+}
+
+template<class Key, class Make>
+static void compare(const char *name, Make make) {
+	size_t pow2_buckets, prime_buckets, pow2_size, prime_size;
+	unsigned long long a = run<Key, sjtu::pow2_index>(make, pow2_buckets, pow2_size);
+	unsigned long long b = run<Key, sjtu::prime_index>(make, prime_buckets, prime_size);
+	int pow2 = (pow2_buckets & (pow2_buckets - 1)) == 0;
+	printf("%-10s size %d / %d, same lookups and order %d, pow2 buckets a power of two %d, prime buckets %d\n", name,
+	       (int)pow2_size, (int)prime_size, (int)(a == b), pow2, (int)prime_buckets);
+}
+
+// batch_fastmod_index() against fastmod_index() at every prime of
+// prime_index, and against % itself
+template<class Key>
+static int check_primes(int &primes) {
+	std::vector<Key> keys;
+	for (int i = 0; i < 257; ++i) keys.push_back((Key)next_rand());
+	keys.push_back((Key)0);
+	keys.push_back((Key)-1);
+	std::vector<size_t> out(keys.size());
+	int wrong = 0;
+	primes = 0;
+	for (size_t p = sjtu::prime_index::round_up(0);; p = sjtu::prime_index::grow(p)) {
+		++primes;
+		std::uint32_t divisor = (std::uint32_t)p;
+		std::uint64_t reciprocal = ~(std::uint64_t)0 / divisor + 1;
+		sjtu::detail::batch_fastmod_index(keys.data(), keys.size(), divisor, reciprocal, out.data());
+		sjtu::prime_index policy;
+		policy.reset(p);
+		for (size_t i = 0; i < keys.size(); ++i) {
+			size_t hash = std::hash<Key>()(keys[i]);
+			std::uint64_t h = hash;
+			wrong += out[i] != sjtu::detail::fastmod_index(hash, divisor, reciprocal);
+			wrong += out[i] != policy(hash);
+			wrong += out[i] != (size_t)((std::uint32_t)(h ^ (h >> 32)) % divisor);
+		}
+		if (sjtu::prime_index::grow(p) == p) break;
+	}
+	return wrong;
+}
+
+int main() {
+	puts("Test: pow2_index and prime_index run the same workload alike");
+	compare<int>("int", [](int i) { return i * 4; });
+	compare<unsigned long long>("u64 << 32", [](int i) { return (unsigned long long)i << 32; });
+	compare<std::string>("string", [](int i) { return "k" + std::to_string(i); });
+
+	puts("Test: batch_fastmod_index at every prime");
+	int primes;
+	int wrong = check_primes<int>(primes);
+	printf("int: %d primes, mismatches %d\n", primes, wrong);
+	wrong = check_primes<unsigned>(primes);
+	printf("unsigned: %d primes, mismatches %d\n", primes, wrong);
+	wrong = check_primes<long long>(primes);
+	printf("long long: %d primes, mismatches %d\n", primes, wrong);
+	wrong = check_primes<unsigned long long>(primes);
+	printf("unsigned long long: %d primes, mismatches %d\n", primes, wrong);
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <string>
+
+typedef sjtu::linked_hashmap<long long, long long> map_type;
+
+static bool same_order(const map_type &a, const map_type &b) {
+	if (a.size() != b.size()) return false;
+	map_type::const_iterator x = a.cbegin(), y = b.cbegin();
+	for (; x != a.cend(); ++x, ++y) {
+		if (x->first != y->first || x->second != y->second) return false;
+	}
+	return true;
+}
+
+static int missing(const map_type &map, long long n, long long step) {
+	int count = 0;
+	for (long long i = 0; i < n; ++i) {
+		const long long *value = map.find_ptr(i * step);
+		count += !value || *value != i;
+	}
+	return count;
+}
+
+void test_growth() {
+	puts("Test: growth past 64K elements with a rehash pool");
+	sjtu::thread_pool pool(4);
+	map_type pooled, plain;
+	pooled.set_rehash_pool(&pool);
+	const long long n = 300000;
+	size_t rehashes = 0, last = pooled.bucket_count();
+	for (long long i = 0; i < n; ++i) {
+		pooled[i * 7] = i;
+		plain[i * 7] = i;
+		if (pooled.bucket_count() != last) {
+			last = pooled.bucket_count();
+			rehashes += pooled.size() >= (1 << 16);
+		}
+	}
+	printf("large rehashes %d, buckets equal %d\n", (int)(rehashes > 0), (int)(pooled.bucket_count() == plain.bucket_count()));
+	printf("missing %d, same order %d\n", missing(pooled, n, 7), (int)same_order(pooled, plain));
+	for (long long i = 0; i < n; i += 3) {
+		pooled.erase(pooled.find(i * 7));
+		plain.erase(plain.find(i * 7));
+	}
+	pooled.reserve(2000000);
+	plain.reserve(2000000);
+	int found = 0;
+	for (long long i = 0; i < n; ++i) found += pooled.contains(i * 7);
+	printf("after erase and reserve: size %d, found %d, same order %d\n", (int)pooled.size(), found,
+	       (int)same_order(pooled, plain));
+	pooled.rehash(100000);
+	plain.rehash(100000);
+	printf("after shrinking rehash: same order %d, buckets %d\n", (int)same_order(pooled, plain),
+	       (int)(pooled.bucket_count() == plain.bucket_count()));
+}
+
+void test_strings() {
+	puts("Test: string keys");
+	sjtu::thread_pool pool(4);
+	sjtu::linked_hashmap<std::string, int> pooled;
+	pooled.set_rehash_pool(&pool);
+	const int n = 100000;
+	for (int i = 0; i < n; ++i) pooled["key" + std::to_string(i)] = i;
+	pooled.reserve(1000000);
+	int wrong = 0, position = 0;
+	for (sjtu::linked_hashmap<std::string, int>::const_iterator it = pooled.cbegin(); it != pooled.cend(); ++it) {
+		wrong += it->second != position++;
+	}
+	for (int i = 0; i < n; ++i) wrong += pooled.get_or("key" + std::to_string(i), -1) != i;
+	printf("size %d, wrong %d\n", (int)pooled.size(), wrong);
+	pooled.set_rehash_pool(nullptr);
+	pooled.reserve(3000000);
+	printf("without the pool again: found %d\n", (int)pooled.contains("key99999"));
+}
+
+int main() {
+	test_growth();
+	test_strings();
+	return 0;
+}
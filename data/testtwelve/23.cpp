@@ -0,0 +1,135 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// every heap allocation of the program is counted
+static long allocations = 0;
+
+void * operator new(std::size_t size) {
+	++allocations;
+	void *p = std::malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept {
+	std::free(p);
+}
+
+// a resource that keeps count of what it hands out and gets back
+class counting_resource : public std::pmr::memory_resource {
+public:
+	long blocks;
+	long bytes;
+	long total_blocks;
+
+	counting_resource() : blocks(0), bytes(0), total_blocks(0) {}
+
+private:
+	void * do_allocate(std::size_t size, std::size_t alignment) override {
+		++blocks;
+		++total_blocks;
+		bytes += (long)size;
+		return std::pmr::new_delete_resource()->allocate(size, alignment);
+	}
+	void do_deallocate(void *p, std::size_t size, std::size_t alignment) override {
+		--blocks;
+		bytes -= (long)size;
+		std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+		return this == &other;
+	}
+};
+
+typedef sjtu::pmr::linked_hashmap<int, int> pmr_map;
+
+void test_arena() {
+	puts("Test: map in a fixed arena");
+	static unsigned char buffer[1 << 22];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+	long before = allocations;
+	{
+		pmr_map map(&arena);
+		for (int i = 0; i < 20000; ++i) map[i] = i * 2;
+		for (int i = 0; i < 20000; i += 2) map.erase(map.find(i));
+		for (int i = 0; i < 5000; ++i) map[-i - 1] = i;
+		long long sum = 0;
+		for (pmr_map::const_iterator it = map.cbegin(); it != map.cend(); ++it) sum += it->second;
+		printf("size %d, sum %lld, resource kept %s\n", (int)map.size(), sum,
+		       map.get_allocator().resource() == &arena ? "yes" : "no");
+	}
+	printf("heap allocations outside the arena: %ld\n", allocations - before);
+}
+
+void test_balance() {
+	puts("Test: every block is given back");
+	counting_resource resource;
+	{
+		pmr_map map(&resource);
+		for (int i = 0; i < 30000; ++i) map[i] = i;
+		map.enable_miss_filter();
+		for (int i = 0; i < 30000; i += 3) map.erase(map.find(i));
+		printf("size %d, live blocks > 0: %s\n", (int)map.size(), resource.blocks > 0 ? "yes" : "no");
+		map.clear();
+		for (int i = 0; i < 100; ++i) map[i] = i;
+		printf("after clear and refill: size %d\n", (int)map.size());
+	}
+	printf("after destruction: blocks %ld, bytes %ld\n", resource.blocks, resource.bytes);
+}
+
+void test_copies() {
+	puts("Test: copies");
+	counting_resource a, b;
+	std::pmr::memory_resource *old_default = std::pmr::set_default_resource(&b);
+	{
+		pmr_map map(&a);
+		for (int i = 0; i < 1000; ++i) map[i] = i;
+		pmr_map copy(map);
+		printf("copy construction uses the default resource: %s\n",
+		       copy.get_allocator().resource() == &b ? "yes" : "no");
+		pmr_map target(&a);
+		target[5] = 5;
+		long before = b.total_blocks;
+		target = copy;
+		printf("copy assignment keeps its own resource: %s, size %d, default resource used: %s\n",
+		       target.get_allocator().resource() == &a ? "yes" : "no", (int)target.size(),
+		       b.total_blocks != before ? "yes" : "no");
+		bool same = true;
+		pmr_map::const_iterator x = map.cbegin(), y = target.cbegin();
+		for (; x != map.cend(); ++x, ++y) same = same && x->first == y->first && x->second == y->second;
+		printf("same order: %s\n", same ? "yes" : "no");
+	}
+	std::pmr::set_default_resource(old_default);
+	printf("balanced: %s\n", a.blocks == 0 && b.blocks == 0 ? "yes" : "no");
+}
+
+void test_bulk_insert() {
+	puts("Test: bulk_insert with a pmr allocator");
+	counting_resource resource;
+	std::vector<std::pair<int, int> > rows;
+	for (int i = 0; i < 100000; ++i) rows.push_back(std::make_pair(i % 70000, i));
+	sjtu::thread_pool pool(4);
+	{
+		pmr_map map(&resource);
+		size_t inserted = map.bulk_insert(rows.begin(), rows.end(), &pool);
+		printf("inserted %d, first %d -> %d, last %d -> %d\n", (int)inserted, map.cbegin()->first, map.cbegin()->second,
+		       (--map.cend())->first, (--map.cend())->second);
+	}
+	printf("balanced: %s\n", resource.blocks == 0 ? "yes" : "no");
+}
+
+int main() {
+	test_arena();
+	test_balance();
+	test_copies();
+	test_bulk_insert();
+	return 0;
+}
@@ -0,0 +1,145 @@
+#include "cache.hpp"
+#include <cstdio>
+#include <list>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// CLOCK written from its definition: a circular list with a hand, new
+// entries placed just behind the hand, a hit sets the entry's flag and
+// eviction clears flags until it finds an entry without one
+class reference_clock {
+	struct entry {
+		int key;
+		int value;
+		bool referenced;
+	};
+	std::list<entry> face;
+	std::list<entry>::iterator hand;
+	size_t cap;
+
+	std::list<entry>::iterator locate(int key) {
+		for (std::list<entry>::iterator it = face.begin(); it != face.end(); ++it) {
+			if (it->key == key) return it;
+		}
+		return face.end();
+	}
+
+public:
+	explicit reference_clock(size_t cap) : hand(face.end()), cap(cap) {}
+
+	bool get(int key, int &value) {
+		std::list<entry>::iterator it = locate(key);
+		if (it == face.end()) return false;
+		it->referenced = true;
+		value = it->value;
+		return true;
+	}
+
+	void put(int key, int value) {
+		std::list<entry>::iterator it = locate(key);
+		if (it != face.end()) {
+			it->value = value;
+			it->referenced = true;
+			return;
+		}
+		if (face.size() >= cap) {
+			for (;;) {
+				if (hand == face.end()) hand = face.begin();
+				if (!hand->referenced) break;
+				hand->referenced = false;
+				++hand;
+			}
+			hand = face.erase(hand);
+		}
+		entry e = {key, value, false};
+		face.insert(hand, e);
+	}
+
+	bool contains(int key) {
+		return locate(key) != face.end();
+	}
+};
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+void test_reference(size_t capacity) {
+	sjtu::clock_cache<int, int> cache(capacity);
+	reference_clock reference(capacity);
+	int hit_mismatches = 0, value_mismatches = 0, content_mismatches = 0;
+	for (int i = 0; i < 20000; ++i) {
+		int key = next_rand() % 4 ? (int)(next_rand() % 40) : (int)(next_rand() % 300);
+		if (next_rand() % 3 == 0) {
+			cache.put(key, i);
+			reference.put(key, i);
+		} else {
+			int a = -1, b = -1;
+			bool found_a = cache.get(key, a), found_b = reference.get(key, b);
+			if (found_a != found_b) ++hit_mismatches;
+			else if (a != b) ++value_mismatches;
+		}
+		if (i % 97 == 0) {
+			for (int k = 0; k < 300; ++k) content_mismatches += cache.contains(k) != reference.contains(k);
+		}
+	}
+	sjtu::cache_stats stats = cache.stats();
+	printf("capacity %3d: hits %5d misses %5d evictions %5d size %3d | mismatches: hit %d value %d content %d\n",
+	       (int)capacity, (int)stats.hits, (int)stats.misses, (int)stats.evictions, (int)cache.size(),
+	       hit_mismatches, value_mismatches, content_mismatches);
+}
+
+void test_second_chance() {
+	puts("Test: a referenced entry survives one sweep");
+	sjtu::clock_cache<int, int> cache(3);
+	cache.put(1, 1);
+	cache.put(2, 2);
+	cache.put(3, 3);
+	int value;
+	cache.get(1, value);
+	cache.put(4, 4);  // clears 1, evicts 2
+	printf("1:%d 2:%d 3:%d 4:%d\n", (int)cache.contains(1), (int)cache.contains(2), (int)cache.contains(3),
+	       (int)cache.contains(4));
+	cache.put(5, 5);  // evicts 3
+	cache.put(6, 6);  // the hand wraps to 1, whose flag was cleared
+	printf("1:%d 3:%d 4:%d 5:%d 6:%d size %d\n", (int)cache.contains(1), (int)cache.contains(3),
+	       (int)cache.contains(4), (int)cache.contains(5), (int)cache.contains(6), (int)cache.size());
+}
+
+void test_threads() {
+	puts("Test: counts from several threads add up");
+	sjtu::clock_cache<int, int> cache(64);
+	for (int k = 0; k < 64; ++k) cache.put(k, k);
+	const int threads = 6, operations = 20000;
+	std::vector<std::thread> workers;
+	std::vector<long long> sums(threads, 0);
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&cache, &sums, t] {
+			int value;
+			for (int i = 0; i < operations; ++i) {
+				// keys below 128, half of them cached
+				if (cache.get((i * 2 + t) % 128, value)) sums[t] += value;
+			}
+		});
+	}
+	for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+	sjtu::cache_stats stats = cache.stats();
+	long long total = 0;
+	for (int t = 0; t < threads; ++t) total += sums[t];
+	printf("hits + misses = %d (expected %d), hits %d, sum %lld\n", (int)(stats.hits + stats.misses),
+	       threads * operations, (int)stats.hits, total);
+}
+
+int main() {
+	puts("Test: CLOCK against a reference implementation");
+	const size_t capacities[] = {1, 2, 5, 32, 100};
+	for (size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); ++i) test_reference(capacities[i]);
+	test_second_chance();
+	test_threads();
+	return 0;
+}
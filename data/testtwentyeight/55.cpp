@@ -0,0 +1,89 @@
+#include "interleaved_lookup.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// runs the probes through interleaved_lookup with the given group size
+// and counts the answers that differ from find()
+template<class Map>
+static int mismatches(const Map &map, const std::vector<typename Map::key_type> &probes, size_t group, int &hits) {
+	sjtu::interleaved_lookup<Map> lookup(map, group);
+	std::vector<const typename Map::value_type *> found(probes.size(), nullptr);
+	lookup.find(probes.data(), probes.size(), found.data());
+	int wrong = 0;
+	hits = 0;
+	for (size_t i = 0; i < probes.size(); ++i) {
+		typename Map::const_iterator it = map.find(probes[i]);
+		const typename Map::value_type *expected = it == map.cend() ? nullptr : &*it;
+		wrong += found[i] != expected;
+		hits += found[i] != nullptr;
+	}
+	return wrong;
+}
+
+void test_integers() {
+	puts("Test: integer keys, hits and misses");
+	typedef sjtu::linked_hashmap<long long, int> map_type;
+	map_type map;
+	for (int i = 0; i < 50000; ++i) map[(long long)i * 7] = i;
+	// erased keys leave chains with gaps
+	for (int i = 0; i < 50000; i += 3) map.erase(map.find((long long)i * 7));
+	std::vector<long long> probes;
+	for (int i = 0; i < 20000; ++i) probes.push_back((long long)(next_rand() % 400000));
+	for (int i = 0; i < 5000; ++i) probes.push_back((long long)(next_rand() % 50000) * 7);
+	const size_t groups[] = {1, 2, 7, 16, 64, 100000};
+	for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); ++g) {
+		int hits;
+		int wrong = mismatches(map, probes, groups[g], hits);
+		printf("group %6d: probes %d, hits %d, mismatches %d\n", (int)groups[g], (int)probes.size(), hits, wrong);
+	}
+}
+
+void test_strings() {
+	puts("Test: string keys");
+	typedef sjtu::linked_hashmap<std::string, int> map_type;
+	map_type map;
+	for (int i = 0; i < 3000; ++i) map["key " + std::to_string(i * 13)] = i;
+	std::vector<std::string> probes;
+	for (int i = 0; i < 3000; ++i) probes.push_back("key " + std::to_string(next_rand() % 40000));
+	const size_t groups[] = {1, 16, 5000};
+	for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); ++g) {
+		int hits;
+		int wrong = mismatches(map, probes, groups[g], hits);
+		printf("group %6d: hits %d, mismatches %d\n", (int)groups[g], hits, wrong);
+	}
+}
+
+void test_edges() {
+	puts("Test: edge cases");
+	typedef sjtu::linked_hashmap<int, int> map_type;
+	map_type empty;
+	std::vector<int> probes;
+	for (int i = 0; i < 10; ++i) probes.push_back(i);
+	int hits;
+	int wrong = mismatches(empty, probes, 4, hits);
+	printf("empty map: mismatches %d, hits %d\n", wrong, hits);
+	map_type map;
+	map[3] = 30;
+	sjtu::interleaved_lookup<map_type> lookup(map, 0);  // 0 runs one lookup at a time
+	const map_type::value_type *found[1] = {nullptr};
+	lookup.find(probes.data(), 0, found);
+	printf("no keys: untouched %d\n", (int)(found[0] == nullptr));
+	lookup.find(probes.data() + 3, 1, found);
+	printf("single key: %d\n", found[0] ? found[0]->second : -1);
+}
+
+int main() {
+	test_integers();
+	test_strings();
+	test_edges();
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+
+// a key that remembers whether it was moved from
+struct tracked_key {
+	int id;
+	bool moved_from;
+
+	explicit tracked_key(int id) : id(id), moved_from(false) {}
+	tracked_key(const tracked_key &other) : id(other.id), moved_from(false) {}
+	tracked_key(tracked_key &&other) noexcept : id(other.id), moved_from(false) { other.moved_from = true; }
+
+	bool operator==(const tracked_key &other) const {
+		return id == other.id;
+	}
+};
+
+struct tracked_hash {
+	size_t operator()(const tracked_key &key) const {
+		return std::hash<int>()(key.id);
+	}
+};
+
+typedef sjtu::linked_hashmap<tracked_key, int, tracked_hash> tracked_map;
+
+void test_compute() {
+	puts("Test: compute");
+	sjtu::linked_hashmap<std::string, int> map;
+	int *v = map.compute("a", [](const std::string &, int *current) -> std::optional<int> {
+		return current ? *current + 1 : 1;
+	});
+	printf("inserted a=%d\n", *v);
+	v = map.compute("a", [](const std::string &, int *current) -> std::optional<int> {
+		return current ? *current + 1 : 1;
+	});
+	printf("replaced a=%d\n", *v);
+	v = map.compute("b", [](const std::string &, int *) -> std::optional<int> { return std::nullopt; });
+	printf("nothing for b: %d, size %d\n", (int)(v == nullptr), (int)map.size());
+	v = map.compute("a", [](const std::string &, int *) -> std::optional<int> { return std::nullopt; });
+	printf("erased a: %d, size %d\n", (int)(v == nullptr), (int)map.size());
+}
+
+void test_compute_if_present() {
+	puts("Test: compute_if_present");
+	sjtu::linked_hashmap<int, int> map;
+	map[1] = 10;
+	map[2] = 20;
+	int *v = map.compute_if_present(1, [](const int &, int &value) { value *= 2; return true; });
+	printf("updated 1=%d\n", *v);
+	v = map.compute_if_present(2, [](const int &, int &) { return false; });
+	printf("erased 2: %d, contains %d\n", (int)(v == nullptr), (int)map.contains(2));
+	int calls = 0;
+	v = map.compute_if_present(3, [&calls](const int &, int &) { ++calls; return true; });
+	printf("absent 3: %d, calls %d\n", (int)(v == nullptr), calls);
+}
+
+void test_compute_if_absent() {
+	puts("Test: compute_if_absent");
+	sjtu::linked_hashmap<int, std::unique_ptr<std::string> > map;
+	int calls = 0;
+	auto make = [&calls](const int &key) {
+		++calls;
+		return std::unique_ptr<std::string>(new std::string(std::to_string(key * key)));
+	};
+	std::unique_ptr<std::string> &a = map.compute_if_absent(12, make);
+	std::unique_ptr<std::string> &b = map.compute_if_absent(12, make);
+	printf("value %s, same entry %d, calls %d\n", a->c_str(), (int)(&a == &b), calls);
+	// a result of another type converts
+	sjtu::linked_hashmap<int, std::string> names;
+	names.compute_if_absent(1, [](const int &) { return "one"; });
+	printf("converted: %s\n", names.get_or(1, "").c_str());
+}
+
+void test_merge() {
+	puts("Test: merge");
+	sjtu::linked_hashmap<std::string, int> counts;
+	const char *words[] = {"the", "cat", "the", "hat", "the", "cat"};
+	for (int i = 0; i < 6; ++i) counts.merge(words[i], 1, [](int &count, int one) { count += one; });
+	for (sjtu::linked_hashmap<std::string, int>::const_iterator it = counts.cbegin(); it != counts.cend(); ++it) {
+		printf("  %s %d\n", it->first.c_str(), it->second);
+	}
+	sjtu::linked_hashmap<int, std::unique_ptr<int> > owned;
+	owned.merge(1, std::unique_ptr<int>(new int(5)), [](std::unique_ptr<int> &, std::unique_ptr<int>) {});
+	owned.merge(1, std::unique_ptr<int>(new int(7)),
+	            [](std::unique_ptr<int> &current, std::unique_ptr<int> more) { *current += *more; });
+	printf("move-only values: %d\n", **owned.find_ptr(1));
+}
+
+void test_rvalue_keys() {
+	puts("Test: rvalue keys are moved only on insertion");
+	tracked_map map;
+	tracked_key k1(1), k2(1), k3(2), k4(2), k5(3), k6(3);
+	map.compute(std::move(k1), [](const tracked_key &, int *) -> std::optional<int> { return 1; });
+	map.compute(std::move(k2), [](const tracked_key &, int *) -> std::optional<int> { return 2; });
+	printf("compute: moved on insert %d, on update %d, value %d\n", (int)k1.moved_from, (int)k2.moved_from,
+	       map.get_or(tracked_key(1), 0));
+	map.compute_if_absent(std::move(k3), [](const tracked_key &key) { return key.id * 10; });
+	map.compute_if_absent(std::move(k4), [](const tracked_key &) { return -1; });
+	printf("compute_if_absent: moved on insert %d, when present %d, value %d\n", (int)k3.moved_from,
+	       (int)k4.moved_from, map.get_or(tracked_key(2), 0));
+	map.merge(std::move(k5), 5, [](int &current, int more) { current += more; });
+	map.merge(std::move(k6), 6, [](int &current, int more) { current += more; });
+	printf("merge: moved on insert %d, when present %d, value %d\n", (int)k5.moved_from, (int)k6.moved_from,
+	       map.get_or(tracked_key(3), 0));
+	tracked_key k7(4);
+	map.merge(k7, 1, [](int &, int) {});
+	printf("lvalue key left alone: %d, size %d\n", (int)k7.moved_from, (int)map.size());
+}
+
+void test_throwing_fn() {
+	puts("Test: a throwing fn leaves the map unchanged");
+	sjtu::linked_hashmap<int, int> map;
+	map[1] = 1;
+	int thrown = 0;
+	try {
+		map.compute_if_absent(2, [](const int &) -> int { throw 7; });
+	} catch (int) { ++thrown; }
+	try {
+		map.compute(3, [](const int &, int *) -> std::optional<int> { throw 7; });
+	} catch (int) { ++thrown; }
+	printf("thrown %d, size %d, contains 2: %d, 3: %d\n", thrown, (int)map.size(), (int)map.contains(2),
+	       (int)map.contains(3));
+	map[2] = 2;
+	printf("still usable: size %d\n", (int)map.size());
+}
+
+int main() {
+	test_compute();
+	test_compute_if_present();
+	test_compute_if_absent();
+	test_merge();
+	test_rvalue_keys();
+	test_throwing_fn();
+	return 0;
+}
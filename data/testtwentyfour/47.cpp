@@ -0,0 +1,137 @@
+#include "group_by.hpp"
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct row {
+	int key;
+	long long value;
+};
+
+// the distinct values of a group, in first-seen order
+struct first_values {
+	std::vector<long long> values;
+
+	void add(long long value) {
+		for (size_t i = 0; i < values.size(); ++i) {
+			if (values[i] == value) return;
+		}
+		values.push_back(value);
+	}
+
+	void merge(const first_values &other) {
+		for (size_t i = 0; i < other.values.size(); ++i) add(other.values[i]);
+	}
+};
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+typedef sjtu::group_by<int, long long> basic_groups;
+
+// count, sum, min and max per key, keys in first-seen order
+static bool matches_reference(const basic_groups &groups, const std::vector<row> &rows) {
+	std::vector<int> order;
+	std::map<int, sjtu::basic_aggregate<long long> > reference;
+	for (size_t i = 0; i < rows.size(); ++i) {
+		if (!reference.count(rows[i].key)) order.push_back(rows[i].key);
+		reference[rows[i].key].add(rows[i].value);
+	}
+	if (order.size() != groups.size()) return false;
+	size_t i = 0;
+	for (basic_groups::map_type::const_iterator it = groups.groups().cbegin(); it != groups.groups().cend(); ++it, ++i) {
+		const sjtu::basic_aggregate<long long> &want = reference[order[i]];
+		if (it->first != order[i] || it->second.count != want.count || it->second.sum != want.sum ||
+		    it->second.min != want.min || it->second.max != want.max) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void test_parallel(size_t threads, size_t rows_count, int key_range) {
+	std::vector<row> rows;
+	for (size_t i = 0; i < rows_count; ++i) {
+		rows.push_back(row{(int)(next_rand() % (unsigned)key_range), (long long)(next_rand() % 1000) - 500});
+	}
+	sjtu::thread_pool pool(threads);
+	basic_groups serial, parallel;
+	serial.add(rows.begin(), rows.end(), [](const row &r) { return r.key; }, [](const row &r) { return r.value; });
+	parallel.add_parallel(rows.begin(), rows.end(), [](const row &r) { return r.key; },
+	                      [](const row &r) { return r.value; }, pool);
+	printf("threads %d, rows %d: groups %d, serial ok %d, parallel ok %d\n", (int)pool.size(), (int)rows_count,
+	       (int)parallel.size(), (int)matches_reference(serial, rows), (int)matches_reference(parallel, rows));
+}
+
+void test_custom_aggregate() {
+	puts("Test: a custom aggregate merges chunks in row order");
+	std::vector<std::pair<std::string, long long> > rows;
+	const char *names[] = {"north", "south", "east", "west", "centre"};
+	for (int i = 0; i < 5000; ++i) rows.push_back(std::make_pair(std::string(names[next_rand() % 5]), (long long)(i % 7)));
+	sjtu::thread_pool pool(4);
+	typedef sjtu::group_by<std::string, long long, first_values> value_groups;
+	value_groups serial, parallel;
+	typedef std::pair<std::string, long long> entry;
+	serial.add(rows.begin(), rows.end(), [](const entry &e) { return e.first; }, [](const entry &e) { return e.second; });
+	parallel.add_parallel(rows.begin(), rows.end(), [](const entry &e) { return e.first; },
+	                      [](const entry &e) { return e.second; }, pool);
+	value_groups::map_type::const_iterator a = serial.groups().cbegin(), b = parallel.groups().cbegin();
+	for (; a != serial.groups().cend(); ++a, ++b) {
+		printf("  %-6s", a->first.c_str());
+		for (size_t i = 0; i < a->second.values.size(); ++i) printf(" %lld", a->second.values[i]);
+		printf(" | same in parallel: %d\n", (int)(a->first == b->first && a->second.values == b->second.values));
+	}
+}
+
+void test_merge() {
+	puts("Test: merge appends the other's groups");
+	basic_groups left, right;
+	left.add(1, 10);
+	left.add(2, 20);
+	right.add(3, 30);
+	right.add(1, 5);
+	left.merge(right);
+	for (basic_groups::map_type::const_iterator it = left.groups().cbegin(); it != left.groups().cend(); ++it) {
+		printf("  %d: count %d sum %lld min %lld max %lld\n", it->first, (int)it->second.count, it->second.sum,
+		       it->second.min, it->second.max);
+	}
+}
+
+void test_hash_of() {
+	puts("Test: hash_of returns the cached hash");
+	sjtu::linked_hashmap<std::string, int> map;
+	std::hash<std::string> hasher;
+	for (int i = 0; i < 1000; ++i) map[std::to_string(i * 7919)] = i;
+	map.rehash(4096);
+	int wrong = 0;
+	for (sjtu::linked_hashmap<std::string, int>::const_iterator it = map.cbegin(); it != map.cend(); ++it) {
+		wrong += map.hash_of(it) != hasher(it->first);
+	}
+	printf("wrong hashes: %d\n", wrong);
+	int thrown = 0;
+	sjtu::linked_hashmap<std::string, int> other;
+	other["x"] = 1;
+	try { map.hash_of(map.cend()); } catch (sjtu::invalid_iterator &) { ++thrown; }
+	try { map.hash_of(other.cbegin()); } catch (sjtu::invalid_iterator &) { ++thrown; }
+	printf("bad iterators: %d of 2 threw\n", thrown);
+}
+
+int main() {
+	puts("Test: add_parallel against add and a reference");
+	test_parallel(1, 1000, 50);
+	test_parallel(2, 3, 10);
+	test_parallel(2, 20000, 300);
+	test_parallel(4, 50000, 5000);
+	test_parallel(3, 30000, 100000);
+	test_custom_aggregate();
+	test_merge();
+	test_hash_of();
+	return 0;
+}
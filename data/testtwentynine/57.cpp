@@ -0,0 +1,131 @@
+#include "linked_hashmap.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+static unsigned long long state = 88172645463325252ull;
+static unsigned long long next_rand() {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+template<class Map>
+static bool same(const Map &a, const Map &b) {
+	if (a.size() != b.size()) return false;
+	typename Map::const_iterator x = a.cbegin(), y = b.cbegin();
+	for (; x != a.cend(); ++x, ++y) {
+		if (!(x->first == y->first) || !(x->second == y->second)) return false;
+	}
+	return true;
+}
+
+// insert_batch() against insert() one by one, then find_batch() against
+// find(); make(i) gives the i-th key, with repeats inside a batch
+template<class Key, class Make>
+static void check_batches(const char *name, Make make, bool filter) {
+	typedef sjtu::linked_hashmap<Key, int> map_type;
+	std::vector<typename map_type::value_type> values;
+	for (int i = 0; i < 5000; ++i) values.push_back(typename map_type::value_type(make(i), i));
+	map_type batched, sequential;
+	if (filter) {
+		batched.enable_miss_filter(10);
+		sequential.enable_miss_filter(10);
+	}
+	sequential[make(3)] = -3;  // already present before the batch
+	batched[make(3)] = -3;
+	size_t expected = 0;
+	for (size_t i = 0; i < values.size(); ++i) expected += sequential.insert(values[i]).second;
+	size_t inserted = 0;
+	// uneven pieces, so batches end at different places
+	for (size_t first = 0; first < values.size(); ) {
+		size_t n = 1 + (size_t)(next_rand() % 100);
+		if (first + n > values.size()) n = values.size() - first;
+		inserted += batched.insert_batch(values.data() + first, n);
+		first += n;
+	}
+
+	bool order = same(batched, sequential);
+
+	// erase some keys, so that the probes miss as well
+	std::vector<Key> erased;
+	for (typename map_type::const_iterator it = batched.cbegin(); it != batched.cend(); ++it) {
+		if (next_rand() % 3 == 0) erased.push_back(it->first);
+	}
+	for (size_t i = 0; i < erased.size(); ++i) batched.erase(batched.find(erased[i]));
+	std::vector<Key> probes;
+	for (int i = 0; i < 3000; ++i) probes.push_back(make((int)(next_rand() % 12000)));
+	std::vector<const typename map_type::value_type *> found(probes.size());
+	const map_type &view = batched;
+	view.find_batch(probes.data(), probes.size(), found.data());
+	int wrong = 0, hits = 0;
+	for (size_t i = 0; i < probes.size(); ++i) {
+		typename map_type::const_iterator it = view.find(probes[i]);
+		wrong += found[i] != (it == view.cend() ? nullptr : &*it);
+		hits += found[i] != nullptr;
+	}
+	printf("%-20s size %d, inserted %d (expected %d), same order %d, find_batch hits %d, mismatches %d\n", name,
+	       (int)sequential.size(), (int)inserted, (int)expected, (int)order, hits, wrong);
+}
+
+// the AVX2 kernels against the scalar reductions
+template<class Key>
+static void check_kernels(const char *name) {
+	std::vector<Key> keys;
+	keys.push_back(0);
+	keys.push_back(1);
+	keys.push_back(std::numeric_limits<Key>::max());
+	keys.push_back(std::numeric_limits<Key>::min());
+	keys.push_back((Key)-1);
+	while (keys.size() < 1003) keys.push_back((Key)next_rand());
+	std::vector<size_t> out(keys.size());
+	int wrong = 0;
+	const std::uint32_t divisors[] = {29u, 769u, 98317u, 3145739u, 3221225473u};
+	for (std::uint32_t divisor : divisors) {
+		std::uint64_t reciprocal = ~(std::uint64_t)0 / divisor + 1;
+#ifdef SJTU_BATCH_HASH_AVX2
+		if (sjtu::detail::cpu_has_avx2()) {
+			sjtu::detail::batch_fastmod_index_avx2(keys.data(), keys.size(), divisor, reciprocal, out.data());
+		} else
+#endif
+		sjtu::detail::batch_fastmod_index(keys.data(), keys.size(), divisor, reciprocal, out.data());
+		for (size_t i = 0; i < keys.size(); ++i) {
+			std::uint64_t h = (std::uint64_t)(size_t)keys[i];
+			wrong += out[i] != (size_t)((std::uint32_t)(h ^ (h >> 32)) % divisor);
+		}
+	}
+	for (unsigned shift = 34; shift <= 63; shift += 3) {
+#ifdef SJTU_BATCH_HASH_AVX2
+		if (sjtu::detail::cpu_has_avx2()) {
+			sjtu::detail::batch_fibonacci_index_avx2(keys.data(), keys.size(), shift, out.data());
+		} else
+#endif
+		sjtu::detail::batch_fibonacci_index(keys.data(), keys.size(), shift, out.data());
+		for (size_t i = 0; i < keys.size(); ++i) {
+			std::uint64_t h = (std::uint64_t)(size_t)keys[i];
+			wrong += out[i] != (size_t)((h * sjtu::detail::FIBONACCI_MULTIPLIER) >> shift);
+		}
+	}
+	printf("%-20s vector and scalar indices differ: %d\n", name, wrong);
+}
+
+int main() {
+	puts("Test: insert_batch and find_batch against insert and find");
+	check_batches<int>("int", [](int i) { return (i * 7919) % 3001 - 1500; }, false);
+	check_batches<unsigned>("unsigned", [](int i) { return (unsigned)(i % 2500) * 2654435761u; }, false);
+	check_batches<long long>("long long", [](int i) { return (long long)(i % 4000) * -1000000007ll; }, false);
+	check_batches<unsigned long long>("unsigned long long",
+	                                  [](int i) { return (unsigned long long)(i / 2) << 33; }, false);
+	check_batches<std::string>("string", [](int i) { return std::to_string(i % 3500); }, false);
+	check_batches<int>("int, miss filter", [](int i) { return (i * 31) % 4001; }, true);
+
+	puts("Test: AVX2 and scalar bucket indices");
+	check_kernels<std::int32_t>("int32");
+	check_kernels<std::uint32_t>("uint32");
+	check_kernels<std::int64_t>("int64");
+	check_kernels<std::uint64_t>("uint64");
+	return 0;
+}
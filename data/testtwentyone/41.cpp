@@ -0,0 +1,110 @@
+#include "cache.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// weighs a string by its length
+struct length_weigher {
+	size_t operator()(int, const std::string &value) const {
+		return value.size();
+	}
+};
+
+typedef sjtu::lru_cache<int, std::string, std::hash<int>, std::equal_to<int>, length_weigher> weighed_cache;
+
+static std::vector<std::string> log_lines;
+
+static void record(weighed_cache::evicted_entry *batch, size_t n) {
+	std::string line = "batch of " + std::to_string(n) + ":";
+	for (size_t i = 0; i < n; ++i) {
+		// the listener may take the value
+		std::string value = std::move(batch[i].second);
+		line += " " + std::to_string(batch[i].first) + "=" + value;
+	}
+	log_lines.push_back(line);
+}
+
+static void print_log() {
+	for (size_t i = 0; i < log_lines.size(); ++i) printf("  %s\n", log_lines[i].c_str());
+	log_lines.clear();
+}
+
+void test_weight() {
+	puts("Test: capacity bounds the total weight");
+	weighed_cache cache(10);
+	cache.on_evict(record);
+	cache.put(1, "aaa");
+	cache.put(2, "bbbb");
+	cache.put(3, "cc");
+	printf("size %d weight %d\n", (int)cache.size(), (int)cache.weight());
+	cache.put(4, "ddddd");  // needs 4 more: evicts 1 and 2 in one batch
+	printf("size %d weight %d\n", (int)cache.size(), (int)cache.weight());
+	print_log();
+	cache.put(3, "cccccc");  // grows in place, evicts 4
+	printf("size %d weight %d value %s\n", (int)cache.size(), (int)cache.weight(), cache.get(3)->c_str());
+	print_log();
+	cache.put(5, "this is far too long");  // never inserted
+	cache.put(3, "also much too long");    // replaces and drops 3
+	printf("size %d weight %d contains 3: %d\n", (int)cache.size(), (int)cache.weight(), (int)cache.contains(3));
+	print_log();
+	sjtu::cache_stats stats = cache.stats();
+	printf("evictions %d\n", (int)stats.evictions);
+}
+
+void test_listener_off() {
+	puts("Test: without a listener nothing is kept");
+	weighed_cache cache(4);
+	cache.on_evict(record);
+	cache.put(1, "aa");
+	cache.on_evict(weighed_cache::eviction_listener());
+	cache.put(2, "bb");
+	cache.put(3, "cc");
+	printf("size %d, batches %d\n", (int)cache.size(), (int)log_lines.size());
+}
+
+void test_rejections_reported() {
+	puts("Test: rejected entries reach the listener");
+	weighed_cache cache(4);
+	cache.on_evict(record);
+	cache.enable_admission(64);
+	for (int round = 0; round < 3; ++round) {
+		for (int k = 0; k < 4; ++k) {
+			if (!cache.get(k)) cache.put(k, std::string(1, (char)('a' + k)));
+		}
+	}
+	cache.put(9, "z");
+	printf("contains 9: %d, rejections %d\n", (int)cache.contains(9), (int)cache.stats().rejections);
+	print_log();
+}
+
+void test_every_victim() {
+	puts("Test: admission compares against every victim");
+	weighed_cache cache(4);
+	cache.on_evict(record);
+	cache.enable_admission(64);
+	cache.put(1, "a");   // cold
+	cache.put(2, "bb");  // hot
+	cache.put(3, "c");
+	cache.get(1);
+	cache.get(3);
+	for (int i = 0; i < 6; ++i) cache.get(2);
+	// least recent first: 1, 3, 2; the newcomer is warmer than 1 and 3
+	for (int i = 0; i < 3; ++i) cache.get(7);
+	cache.put(7, "gg");  // needs room from 1 and 3
+	printf("light newcomer: contains 7 %d, 1 %d, 2 %d, 3 %d\n", (int)cache.contains(7), (int)cache.contains(1),
+	       (int)cache.contains(2), (int)cache.contains(3));
+	print_log();
+	for (int i = 0; i < 3; ++i) cache.get(8);
+	cache.put(8, "hhhh");  // would evict 2 and 7; 2 is hotter
+	printf("heavy newcomer: contains 8 %d, 2 %d, 7 %d, rejections %d\n", (int)cache.contains(8),
+	       (int)cache.contains(2), (int)cache.contains(7), (int)cache.stats().rejections);
+	print_log();
+}
+
+int main() {
+	test_weight();
+	test_listener_off();
+	test_rejections_reported();
+	test_every_victim();
+	return 0;
+}
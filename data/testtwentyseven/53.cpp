@@ -0,0 +1,117 @@
+#include "flat_combining.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// throws for keys ending in 7; yields first, so that other threads
+// publish operations meanwhile and batches form even on one core
+struct picky_hash {
+	size_t operator()(int key) const {
+		std::this_thread::yield();
+		if (key % 10 == 7) throw std::invalid_argument("unhashable");
+		return std::hash<int>()(key);
+	}
+};
+
+// a value whose copy throws when it is negative
+struct fragile {
+	int value;
+
+	fragile() : value(0) {}
+	explicit fragile(int value) : value(value) {}
+	fragile(const fragile &other) : value(other.value) {
+		if (value < 0) throw std::length_error("fragile");
+	}
+	fragile & operator=(const fragile &other) {
+		if (other.value < 0) throw std::length_error("fragile");
+		value = other.value;
+		return *this;
+	}
+};
+
+typedef sjtu::flat_combining_map<int, fragile, picky_hash> map_type;
+
+struct outcome {
+	int hash_errors;
+	int copy_errors;
+	int wrong;
+	int found;
+};
+
+// thread t works on the keys [t * 1000, t * 1000 + 1000)
+static void work(map_type &map, size_t t, outcome &result) {
+	result = outcome{0, 0, 0, 0};
+	int base = (int)t * 1000;
+	for (int round = 0; round < 3; ++round) {
+		for (int k = base; k < base + 1000; ++k) {
+			// every 13th key gets a value that cannot be copied in
+			int value = k % 13 == 0 ? -1 : k + round;
+			try {
+				bool inserted = round == 1 ? map.assign(t, k, fragile(value)) : map.insert(t, k, fragile(value));
+				bool expected = round == 0;
+				if (k % 13 == 0) ++result.wrong;  // should have thrown
+				else if (inserted != expected) ++result.wrong;
+			} catch (std::invalid_argument &) {
+				++result.hash_errors;
+				if (k % 10 != 7) ++result.wrong;
+			} catch (std::length_error &) {
+				++result.copy_errors;
+				if (k % 13 != 0 || k % 10 == 7) ++result.wrong;
+			}
+		}
+		for (int k = base; k < base + 1000; ++k) {
+			fragile out;
+			try {
+				bool found = map.find(t, k, out);
+				bool expected = k % 13 != 0;
+				if (found != expected) ++result.wrong;
+				// round 1 assigned k + 1; round 2 only inserted
+				else if (found && out.value != k + (round == 0 ? 0 : 1)) ++result.wrong;
+				result.found += found;
+			} catch (std::invalid_argument &) {
+				++result.hash_errors;
+				if (k % 10 != 7) ++result.wrong;
+			}
+		}
+	}
+	// erase the odd keys
+	for (int k = base + 1; k < base + 1000; k += 2) {
+		try {
+			bool erased = map.erase(t, k);
+			if (erased != (k % 13 != 0)) ++result.wrong;
+		} catch (std::invalid_argument &) {
+			++result.hash_errors;
+			if (k % 10 != 7) ++result.wrong;
+		}
+	}
+}
+
+void test_threads(size_t threads) {
+	map_type map(threads);
+	std::vector<outcome> results(threads);
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threads; ++t) workers.emplace_back(work, std::ref(map), t, std::ref(results[t]));
+	for (size_t t = 0; t < threads; ++t) workers[t].join();
+
+	outcome total = {0, 0, 0, 0};
+	for (size_t t = 0; t < threads; ++t) {
+		total.hash_errors += results[t].hash_errors;
+		total.copy_errors += results[t].copy_errors;
+		total.wrong += results[t].wrong;
+		total.found += results[t].found;
+	}
+	// even keys neither ending in 7 nor multiples of 13 remain
+	size_t expected = 0;
+	for (int k = 0; k < (int)threads * 1000; k += 2) expected += k % 10 != 7 && k % 13 != 0;
+	printf("threads %d: hash errors %d, copy errors %d, found %d, wrong %d, size %d (expected %d)\n", (int)threads,
+	       total.hash_errors, total.copy_errors, total.found, total.wrong, (int)map.size(), (int)expected);
+}
+
+int main() {
+	puts("Test: exceptions reach the thread whose operation raised them");
+	test_threads(1);
+	test_threads(4);
+	test_threads(8);
+	return 0;
+}
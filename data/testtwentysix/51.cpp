@@ -0,0 +1,140 @@
+#include "stamped_shards.hpp"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef sjtu::linked_hashmap<int, std::string> map_type;
+typedef sjtu::stamped_shards<int, std::string> shards_type;
+
+struct row {
+	int key;
+	std::string value;
+};
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static std::vector<row> make_rows(size_t n, int key_range) {
+	std::vector<row> rows;
+	for (size_t i = 0; i < n; ++i) {
+		rows.push_back(row{(int)(next_rand() % (unsigned)key_range), std::to_string(rows.size()) + "v"});
+	}
+	return rows;
+}
+
+static bool same(const map_type &a, const map_type &b) {
+	if (a.size() != b.size()) return false;
+	map_type::const_iterator x = a.cbegin(), y = b.cbegin();
+	for (; x != a.cend(); ++x, ++y) {
+		if (x->first != y->first || x->second != y->second) return false;
+	}
+	return true;
+}
+
+// rows [begin, end) spread over the shards by threads, stamped with their index
+static void fill(shards_type &shards, const std::vector<row> &rows, size_t begin, size_t end) {
+	size_t threads = shards.size();
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threads; ++t) {
+		workers.emplace_back([&shards, &rows, begin, end, threads, t] {
+			// interleaved, so every shard sees keys from all over the input
+			for (size_t i = begin + t; i < end; i += threads) shards[t].insert(rows[i].key, rows[i].value, i);
+		});
+	}
+	for (size_t t = 0; t < threads; ++t) workers[t].join();
+}
+
+void test_merge(size_t threads, size_t n, int key_range) {
+	std::vector<row> rows = make_rows(2 * n, key_range);
+	shards_type shards(threads);
+	map_type merged, sequential;
+
+	fill(shards, rows, 0, n);
+	shards.merge_into(merged);
+	for (size_t i = 0; i < n; ++i) sequential.try_emplace(rows[i].key, rows[i].value);
+	bool first = same(merged, sequential);
+	size_t emptied = 0;
+	for (size_t t = 0; t < threads; ++t) emptied += shards[t].size() == 0;
+
+	// the shards are reused for the rest of the rows, merged onto the same map
+	fill(shards, rows, n, 2 * n);
+	shards.merge_into(merged);
+	for (size_t i = n; i < 2 * n; ++i) sequential.try_emplace(rows[i].key, rows[i].value);
+	bool second = same(merged, sequential);
+	printf("threads %d, rows %d, keys %d: first merge %d, shards emptied %d, after reuse %d\n", (int)threads,
+	       (int)(2 * n), (int)merged.size(), (int)first, (int)(emptied == threads), (int)second);
+}
+
+void test_existing_keys() {
+	puts("Test: keys already in the result keep their value");
+	shards_type shards(2);
+	map_type out;
+	out[5] = "old";
+	shards[0].insert(5, "new", 0);
+	shards[0].insert(7, "seven", 2);
+	shards[1].insert(6, "six", 1);
+	shards[1].insert(7, "later", 3);
+	shards.merge_into(out);
+	for (map_type::const_iterator it = out.cbegin(); it != out.cend(); ++it) printf("  %d %s\n", it->first, it->second.c_str());
+}
+
+void test_shared_counter() {
+	puts("Test: the shared counter");
+	shards_type shards(3);
+	// from one thread, in order, the counter is the insertion order
+	const int keys[] = {4, 1, 4, 9, 1, 2};
+	for (int i = 0; i < 6; ++i) shards[i % 3].insert(keys[i], std::to_string(i));
+	map_type out;
+	shards.merge_into(out);
+	for (map_type::const_iterator it = out.cbegin(); it != out.cend(); ++it) printf("  %d %s\n", it->first, it->second.c_str());
+
+	// from threads, every key arrives once with the value of one of its rows
+	std::vector<row> rows = make_rows(20000, 500);
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < 3; ++t) {
+		workers.emplace_back([&shards, &rows, t] {
+			for (size_t i = t; i < rows.size(); i += 3) shards[t].insert(rows[i].key, rows[i].value);
+		});
+	}
+	for (size_t t = 0; t < 3; ++t) workers[t].join();
+	map_type threaded;
+	shards.merge_into(threaded);
+	int wrong = 0;
+	for (size_t i = 0; i < rows.size(); ++i) wrong += !threaded.contains(rows[i].key);
+	for (map_type::const_iterator it = threaded.cbegin(); it != threaded.cend(); ++it) {
+		size_t index = (size_t)std::stoul(it->second);
+		wrong += index >= rows.size() || rows[index].key != it->first;
+	}
+	printf("threaded: keys %d, wrong %d\n", (int)threaded.size(), wrong);
+}
+
+void test_clear() {
+	puts("Test: clear");
+	shards_type shards(2);
+	shards[0].insert(1, "a", 0);
+	shards[1].insert(2, "b", 1);
+	shards.clear();
+	map_type out;
+	shards.merge_into(out);
+	shards[1].insert(3, "c", 0);
+	shards.merge_into(out);
+	printf("size %d, first %d\n", (int)out.size(), out.cbegin()->first);
+}
+
+int main() {
+	puts("Test: merge_into equals a sequential first-wins insert");
+	test_merge(1, 1000, 100);
+	test_merge(2, 5000, 1000);
+	test_merge(4, 20000, 3000);
+	test_merge(3, 20000, 100000);
+	test_existing_keys();
+	test_shared_counter();
+	test_clear();
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include "hash_join.hpp"
+#include <cstdio>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct order {
+	int id;
+	int customer;
+};
+
+// counts its copies, to see how often build() copies a row
+struct counted {
+	static int copies;
+	int key;
+	int payload;
+
+	counted(int key, int payload) : key(key), payload(payload) {}
+	counted(const counted &other) : key(other.key), payload(other.payload) { ++copies; }
+	counted(counted &&) noexcept = default;
+	counted & operator=(const counted &other) {
+		key = other.key;
+		payload = other.payload;
+		++copies;
+		return *this;
+	}
+};
+int counted::copies = 0;
+
+static unsigned int state = 2463534242u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+void test_against_nested_loops(bool duplicates) {
+	printf("Test: join against nested loops, duplicates %s\n", duplicates ? "kept" : "dropped");
+	std::vector<order> orders;
+	for (int i = 0; i < 3000; ++i) orders.push_back(order{i, (int)(next_rand() % 500)});
+	std::vector<int> customers;
+	for (int i = 0; i < 1000; ++i) customers.push_back((int)(next_rand() % 700));
+
+	sjtu::hash_join<int, order> join(duplicates);
+	// in two calls, to check that build() appends
+	join.build(orders.begin(), orders.begin() + 1000, [](const order &o) { return o.customer; });
+	join.build(orders.begin() + 1000, orders.end(), [](const order &o) { return o.customer; });
+	std::vector<std::pair<int, int> > got;
+	size_t matches = join.probe(customers.begin(), customers.end(), [](int c) { return c; },
+	                            [&got](int c, const order &o) { got.push_back(std::make_pair(c, o.id)); });
+
+	// probe order, and build order within a key
+	std::vector<std::pair<int, int> > expected;
+	for (size_t i = 0; i < customers.size(); ++i) {
+		for (size_t j = 0; j < orders.size(); ++j) {
+			if (orders[j].customer != customers[i]) continue;
+			expected.push_back(std::make_pair(customers[i], orders[j].id));
+			if (!duplicates) break;
+		}
+	}
+	printf("keys %d, rows %d, matches %d, equal to nested loops: %d\n", (int)join.key_count(), (int)join.size(),
+	       (int)matches, (int)(got == expected));
+}
+
+void test_copies() {
+	puts("Test: build copies each kept row once");
+	std::vector<counted> rows;
+	for (int i = 0; i < 100; ++i) rows.push_back(counted(i % 10, i));
+	counted::copies = 0;
+	sjtu::hash_join<int, counted> with(true);
+	with.build(rows.begin(), rows.end(), [](const counted &r) { return r.key; });
+	printf("duplicates kept: %d copies for %d rows\n", counted::copies, (int)with.size());
+	counted::copies = 0;
+	sjtu::hash_join<int, counted> without(false);
+	without.build(rows.begin(), rows.end(), [](const counted &r) { return r.key; });
+	printf("duplicates dropped: %d copies for %d rows\n", counted::copies, (int)without.size());
+	int first = 0;
+	std::vector<int> probe(1, 3);
+	without.probe(probe.begin(), probe.end(), [](int k) { return k; },
+	              [&first](int, const counted &r) { first = r.payload; });
+	printf("first row of key 3 wins: payload %d\n", first);
+}
+
+void test_input_iterators_and_strings() {
+	puts("Test: input iterators and string keys");
+	std::istringstream in("apple pear apple fig pear apple");
+	sjtu::hash_join<std::string, std::string> join;
+	join.build(std::istream_iterator<std::string>(in), std::istream_iterator<std::string>(),
+	           [](const std::string &s) { return s; });
+	printf("keys %d, rows %d\n", (int)join.key_count(), (int)join.size());
+	std::vector<std::string> probe;
+	probe.push_back("fig");
+	probe.push_back("kiwi");
+	probe.push_back("apple");
+	size_t matches = join.probe(probe.begin(), probe.end(), [](const std::string &s) { return s; },
+	                            [](const std::string &p, const std::string &b) {
+		printf("  %s-%s\n", p.c_str(), b.c_str());
+	});
+	printf("matches %d\n", (int)matches);
+	join.clear();
+	printf("after clear: keys %d, rows %d, matches %d\n", (int)join.key_count(), (int)join.size(),
+	       (int)join.probe(probe.begin(), probe.end(), [](const std::string &s) { return s; },
+	                       [](const std::string &, const std::string &) {}));
+}
+
+int main() {
+	test_against_nested_loops(true);
+	test_against_nested_loops(false);
+	test_copies();
+	test_input_iterators_and_strings();
+	return 0;
+}
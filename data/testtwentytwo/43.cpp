@@ -0,0 +1,158 @@
+#include "linked_hashmap.hpp"
+#include <cstdio>
+#include <list>
+#include <utility>
+
+typedef sjtu::linked_hashmap<int, int> map_type;
+
+static unsigned int state = 88172645u;
+static unsigned int next_rand() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// whether map holds exactly the entries of reference, in its order, and
+// finds each of them by key
+static bool same(map_type &map, const std::list<std::pair<int, int> > &reference) {
+	if (map.size() != reference.size()) return false;
+	std::list<std::pair<int, int> >::const_iterator r = reference.begin();
+	for (map_type::iterator it = map.begin(); it != map.end(); ++it, ++r) {
+		if (it->first != r->first || it->second != r->second) return false;
+	}
+	for (r = reference.begin(); r != reference.end(); ++r) {
+		const int *value = map.find_ptr(r->first);
+		if (!value || *value != r->second) return false;
+	}
+	return true;
+}
+
+static std::list<std::pair<int, int> >::iterator locate(std::list<std::pair<int, int> > &l, int key) {
+	for (std::list<std::pair<int, int> >::iterator it = l.begin(); it != l.end(); ++it) {
+		if (it->first == key) return it;
+	}
+	return l.end();
+}
+
+void test_against_list() {
+	puts("Test: queue operations against std::list");
+	map_type map;
+	std::list<std::pair<int, int> > reference;
+	int mismatches = 0, checks = 0;
+	for (int i = 0; i < 30000; ++i) {
+		unsigned op = next_rand() % 10;
+		int key = (int)(next_rand() % 2000);
+		if (op < 4) {
+			if (map.insert(sjtu::pair<const int, int>(key, i)).second) reference.push_back(std::make_pair(key, i));
+		} else if (op == 4 && !map.empty()) {
+			if (map.front().first != reference.front().first) ++mismatches;
+			map.pop_front();
+			reference.pop_front();
+		} else if (op == 5 && !map.empty()) {
+			if (map.back().first != reference.back().first) ++mismatches;
+			map.pop_back();
+			reference.pop_back();
+		} else if (op == 6) {
+			map_type::iterator it = map.find(key);
+			if (it != map.end()) {
+				map.move_to_front(it);
+				reference.splice(reference.begin(), reference, locate(reference, key));
+			}
+		} else if (op == 7) {
+			map_type::iterator it = map.find(key);
+			if (it != map.end()) {
+				map.move_to_back(it);
+				reference.splice(reference.end(), reference, locate(reference, key));
+			}
+		} else if (op == 8) {
+			map_type::iterator it = map.find(key), pos = map.find((int)(next_rand() % 2000));
+			if (it != map.end() && pos != map.end()) {
+				std::list<std::pair<int, int> >::iterator r = locate(reference, it->first);
+				std::list<std::pair<int, int> >::iterator p = locate(reference, pos->first);
+				map.move_before(it, pos);
+				if (r != p) reference.splice(p, reference, r);
+			}
+		} else {
+			// mostly a few, sometimes most of the map, to take both paths
+			size_t k = next_rand() % 8 ? next_rand() % 5 : map.size() * 3 / 4;
+			size_t erased = map.trim_front(k);
+			size_t expected = k < reference.size() ? k : reference.size();
+			if (erased != expected) ++mismatches;
+			for (size_t j = 0; j < expected; ++j) reference.pop_front();
+		}
+		if (i % 101 == 0) {
+			++checks;
+			mismatches += !same(map, reference);
+		}
+	}
+	mismatches += !same(map, reference);
+	printf("checks %d, mismatches %d, final size %d\n", checks, mismatches, (int)map.size());
+}
+
+void test_queue() {
+	puts("Test: a queue without duplicates");
+	map_type map;
+	for (int i = 0; i < 10; ++i) map[i] = i * i;
+	map.insert(sjtu::pair<const int, int>(3, 0));  // already queued
+	printf("front %d=%d back %d=%d size %d\n", map.front().first, map.front().second, map.back().first,
+	       map.back().second, (int)map.size());
+	map.front().second = -1;
+	map.pop_front();
+	map.pop_back();
+	printf("front %d back %d size %d\n", map.front().first, map.back().first, (int)map.size());
+	size_t erased = map.trim_front(3);
+	printf("trim_front(3) erased %d, front %d\n", (int)erased, map.front().first);
+	printf("trim_front(0) erased %d\n", (int)map.trim_front(0));
+	erased = map.trim_front(100);
+	printf("trim_front(100) erased %d, size %d\n", (int)erased, (int)map.size());
+	map[42] = 1;
+	printf("reusable: front %d back %d\n", map.front().first, map.back().first);
+}
+
+void test_large_trim() {
+	puts("Test: trim_front on a large map keeps the rest findable");
+	map_type map;
+	for (int i = 0; i < 100000; ++i) map[i] = i;
+	printf("erased %d\n", (int)map.trim_front(90000));
+	int found = 0, gone = 0;
+	for (int i = 0; i < 100000; ++i) {
+		if (map.contains(i)) ++found;
+		else if (i < 90000) ++gone;
+	}
+	printf("found %d, gone %d, front %d\n", found, gone, map.front().first);
+	for (int i = 0; i < 1000; ++i) map[i] = i;
+	printf("size after reinserting %d, back %d\n", (int)map.size(), map.back().first);
+}
+
+void test_errors() {
+	puts("Test: errors");
+	map_type map;
+	const map_type &cmap = map;
+	int thrown = 0;
+	try { map.front(); } catch (sjtu::container_is_empty &) { ++thrown; }
+	try { cmap.back(); } catch (sjtu::container_is_empty &) { ++thrown; }
+	try { map.pop_front(); } catch (sjtu::container_is_empty &) { ++thrown; }
+	try { map.pop_back(); } catch (sjtu::container_is_empty &) { ++thrown; }
+	printf("empty map: %d of 4 threw\n", thrown);
+	printf("trim_front on empty: %d\n", (int)map.trim_front(5));
+	map[1] = 1;
+	map_type other;
+	other[1] = 1;
+	thrown = 0;
+	try { map.move_to_back(map.end()); } catch (sjtu::invalid_iterator &) { ++thrown; }
+	try { map.move_before(other.begin(), map.begin()); } catch (sjtu::invalid_iterator &) { ++thrown; }
+	try { map.move_before(map.begin(), other.end()); } catch (sjtu::invalid_iterator &) { ++thrown; }
+	printf("bad iterators: %d of 3 threw\n", thrown);
+	map.move_before(map.begin(), map.begin());
+	map.move_before(map.begin(), map.end());
+	printf("no-op moves keep size %d\n", (int)map.size());
+}
+
+int main() {
+	test_against_list();
+	test_queue();
+	test_large_trim();
+	test_errors();
+	return 0;
+}
@@ -0,0 +1,232 @@
+/**
+ * fast hash functions for linked_hashmap's Hash parameter.
+ *
+ * std::hash is the identity for integers on libstdc++ and libc++, which
+ * leaves all mixing to the index policy, and a comparatively slow byte
+ * hash for strings. sjtu::fast_hash<Key> provides instead:
+ *
+ *   integers, enums, pointers - one 64x64->128-bit multiply, folded
+ *                               (the wyhash "mum" mix)
+ *   floating point            - the bits of the value, with -0.0 == 0.0;
+ *                               padding of long double is skipped
+ *   std::string, string_view  - a wyhash-style byte hash, reading 8 or
+ *                               16 bytes per step
+ *   sjtu::pair, std::pair,
+ *   std::tuple                - the fast_hash of each member, combined
+ *                               with hash_combine()
+ *
+ * e.g. sjtu::linked_hashmap<std::string, int, sjtu::fast_hash<std::string> >.
+ * The values depend on the seed only, not on the platform's std::hash,
+ * and are not meant to resist hash flooding.
+ */
+#ifndef SJTU_FAST_HASH_HPP
+#define SJTU_FAST_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+
+namespace sjtu {
+namespace detail {
+
+// the default secret of wyhash
+const std::uint64_t WY_SECRET[4] = {
+	0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
+
+// the full 128-bit product of a and b, low half in a and high half in b
+inline void mum(std::uint64_t &a, std::uint64_t &b) {
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 r = (unsigned __int128)a * b;
+	a = (std::uint64_t)r;
+	b = (std::uint64_t)(r >> 64);
+#else
+	std::uint64_t ha = a >> 32, hb = b >> 32, la = (std::uint32_t)a, lb = (std::uint32_t)b;
+	std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	std::uint64_t t = rl + (rm0 << 32), carry = t < rl;
+	std::uint64_t lo = t + (rm1 << 32);
+	carry += lo < t;
+	a = lo;
+	b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+inline std::uint64_t mix(std::uint64_t a, std::uint64_t b) {
+	mum(a, b);
+	return a ^ b;
+}
+
+inline std::uint64_t read8(const unsigned char *p) {
+	std::uint64_t v;
+	std::memcpy(&v, p, 8);
+	return v;
+}
+
+inline std::uint64_t read4(const unsigned char *p) {
+	std::uint32_t v;
+	std::memcpy(&v, p, 4);
+	return v;
+}
+
+// one to three bytes, each of them used
+inline std::uint64_t read3(const unsigned char *p, size_t k) {
+	return ((std::uint64_t)p[0] << 16) | ((std::uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+/**
+ * wyhash-style hash of the len bytes at key.
+ */
+inline std::uint64_t hash_bytes(const void *key, size_t len, std::uint64_t seed = 0) {
+	const unsigned char *p = static_cast<const unsigned char *>(key);
+	const std::uint64_t *s = WY_SECRET;
+	seed ^= mix(seed ^ s[0], s[1]);
+	std::uint64_t a, b;
+	if (len <= 16) {
+		if (len >= 4) {
+			a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+			b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+		} else if (len > 0) {
+			a = read3(p, len);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = len;
+		if (i > 48) {
+			// three independent lanes of 16 bytes each
+			std::uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = mix(read8(p) ^ s[1], read8(p + 8) ^ seed);
+				see1 = mix(read8(p + 16) ^ s[2], read8(p + 24) ^ see1);
+				see2 = mix(read8(p + 32) ^ s[3], read8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16) {
+			seed = mix(read8(p) ^ s[1], read8(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = read8(p + i - 16);
+		b = read8(p + i - 8);
+	}
+	a ^= s[1];
+	b ^= seed;
+	mum(a, b);
+	return mix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+/**
+ * mixes a 64-bit integer into a hash value in which every input bit
+ * affects every output bit.
+ */
+inline std::uint64_t hash_integer(std::uint64_t x, std::uint64_t seed = 0) {
+	return mix(x ^ seed ^ WY_SECRET[0], WY_SECRET[1]);
+}
+
+}
+
+/**
+ * combines the hash value h of the next member into seed.
+ */
+inline size_t hash_combine(size_t seed, size_t h) {
+	return (size_t)detail::mix((std::uint64_t)seed ^ detail::WY_SECRET[2], (std::uint64_t)h ^ detail::WY_SECRET[3]);
+}
+
+template<class Key, class Enable = void>
+struct fast_hash;
+
+template<class Key>
+struct fast_hash<Key, typename std::enable_if<std::is_integral<Key>::value || std::is_enum<Key>::value>::type> {
+	size_t operator()(Key key) const {
+		return (size_t)detail::hash_integer((std::uint64_t)key);
+	}
+};
+
+template<class Key>
+struct fast_hash<Key *> {
+	size_t operator()(Key *key) const {
+		return (size_t)detail::hash_integer((std::uint64_t)(std::uintptr_t)key);
+	}
+};
+
+template<class Key>
+struct fast_hash<Key, typename std::enable_if<std::is_floating_point<Key>::value>::type> {
+	size_t operator()(Key key) const {
+		// -0.0 equals 0.0, so both hash as 0.0
+		if (key == Key(0)) return (size_t)detail::hash_integer(0);
+		if constexpr (sizeof(Key) == sizeof(std::uint32_t)) {
+			std::uint32_t bits;
+			std::memcpy(&bits, &key, sizeof(bits));
+			return (size_t)detail::hash_integer(bits);
+		} else if constexpr (sizeof(Key) == sizeof(std::uint64_t)) {
+			std::uint64_t bits;
+			std::memcpy(&bits, &key, sizeof(bits));
+			return (size_t)detail::hash_integer(bits);
+		} else {
+			// x87 extended precision keeps its 10 value bytes in a 12 or
+			// 16 byte object; the rest is padding of any content
+			const size_t bytes = std::numeric_limits<Key>::digits == 64 ? 10 : sizeof(Key);
+			return (size_t)detail::hash_bytes(&key, bytes);
+		}
+	}
+};
+
+template<class Char, class Traits, class Alloc>
+struct fast_hash<std::basic_string<Char, Traits, Alloc> > {
+	size_t operator()(const std::basic_string<Char, Traits, Alloc> &key) const {
+		return (size_t)detail::hash_bytes(key.data(), key.size() * sizeof(Char));
+	}
+};
+
+template<class Char, class Traits>
+struct fast_hash<std::basic_string_view<Char, Traits> > {
+	size_t operator()(std::basic_string_view<Char, Traits> key) const {
+		return (size_t)detail::hash_bytes(key.data(), key.size() * sizeof(Char));
+	}
+};
+
+template<class T1, class T2>
+struct fast_hash<pair<T1, T2> > {
+	size_t operator()(const pair<T1, T2> &key) const {
+		return hash_combine(fast_hash<typename std::remove_cv<T1>::type>()(key.first),
+		                    fast_hash<typename std::remove_cv<T2>::type>()(key.second));
+	}
+};
+
+template<class T1, class T2>
+struct fast_hash<std::pair<T1, T2> > {
+	size_t operator()(const std::pair<T1, T2> &key) const {
+		return hash_combine(fast_hash<typename std::remove_cv<T1>::type>()(key.first),
+		                    fast_hash<typename std::remove_cv<T2>::type>()(key.second));
+	}
+};
+
+template<class... Ts>
+struct fast_hash<std::tuple<Ts...> > {
+	size_t operator()(const std::tuple<Ts...> &key) const {
+		return combine(key, std::index_sequence_for<Ts...>());
+	}
+
+private:
+	template<size_t... I>
+	static size_t combine(const std::tuple<Ts...> &key, std::index_sequence<I...>) {
+		size_t seed = sizeof...(Ts);
+		((seed = hash_combine(seed, fast_hash<typename std::remove_cv<Ts>::type>()(std::get<I>(key)))), ...);
+		return seed;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,268 @@
+/**
+ * flat-combining wrapper for sharing one linked_hashmap between threads.
+ *
+ * Instead of every thread taking a mutex in turn, a thread publishes its
+ * operation in its own slot and then either finds it done or takes the
+ * lock and becomes the combiner: the combiner runs every operation
+ * pending at that moment as one batch, so the lock changes hands once
+ * per batch rather than once per operation, and the batch gets
+ *   - one find_batch() over all its keys, which hashes them together and
+ *     prefetches their slots before any chain is walked; lookups are
+ *     answered from it, and the writes that follow find their chains in
+ *     cache;
+ *   - one reserve() for all its inserts, instead of a load check each.
+ * The operations of a batch were all pending at once, so running the
+ * lookups before the writes is a valid order: every operation still
+ * takes effect atomically between its call and its return.
+ * An exception from the hasher, Equal, T or an allocation is thrown to
+ * the caller whose operation raised it; if preparing the batch throws,
+ * its operations run one at a time, each reporting its own outcome.
+ *
+ *   sjtu::flat_combining_map<Key, T> map(threads);
+ *   // on thread t, 0 <= t < threads
+ *   map.insert(t, key, value);
+ *   T value;
+ *   if (map.find(t, key, value)) ...
+ *
+ * Each thread passes its own slot number t to every call and has one
+ * operation in flight at a time. A waiting thread yields between
+ * checks, so more threads than cores is fine.
+ */
+#ifndef SJTU_FLAT_COMBINING_HPP
+#define SJTU_FLAT_COMBINING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "exceptions.hpp"
+#include "linked_hashmap.hpp"
+
+namespace sjtu {
+
+template<class Key, class T, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class flat_combining_map {
+public:
+	typedef linked_hashmap<Key, T, Hash, Equal> map_type;
+
+	struct combining_stats {
+		size_t batches;
+		size_t operations;
+	};
+
+private:
+	enum state_type { IDLE, PENDING, DONE };
+	enum op_type { FIND, INSERT, ASSIGN, ERASE };
+
+	// one thread's published operation; a cache line each, so that
+	// publishing does not disturb the other threads' slots
+	struct alignas(64) Slot {
+		std::atomic<int> state;
+		int op;
+		const Key *key;
+		const T *in;
+		T *out;
+		bool result;
+		std::exception_ptr error;
+
+		Slot() : state(IDLE), op(FIND), key(nullptr), in(nullptr), out(nullptr), result(false) {}
+	};
+
+	map_type map;
+	std::vector<Slot> slots;
+	std::mutex lock;
+	// the combiner's scratch space, reused between batches
+	std::vector<Slot *> batch;
+	std::vector<Key> keys;
+	std::vector<const typename map_type::value_type *> found;
+	combining_stats counters;
+
+	// runs one write; lookups are answered from find_batch() in combine()
+	void write(Slot &slot) {
+		switch (slot.op) {
+		case INSERT:
+			slot.result = map.try_emplace(*slot.key, *slot.in).second;
+			break;
+		case ASSIGN: {
+			pair<typename map_type::iterator, bool> inserted = map.try_emplace(*slot.key, *slot.in);
+			if (!inserted.second) inserted.first->second = *slot.in;
+			slot.result = inserted.second;
+			break;
+		}
+		case ERASE: {
+			bool erased = false;
+			map.compute_if_present(*slot.key, [&erased](const Key &, T &) { erased = true; return false; });
+			slot.result = erased;
+			break;
+		}
+		}
+	}
+
+	// runs every pending operation; the caller holds lock
+	void combine() {
+		batch.clear();
+		keys.clear();
+		size_t inserts = 0;
+		for (size_t i = 0; i < slots.size(); ++i) {
+			if (slots[i].state.load(std::memory_order_acquire) != PENDING) continue;
+			batch.push_back(&slots[i]);
+			inserts += slots[i].op == INSERT || slots[i].op == ASSIGN;
+		}
+		if (batch.empty()) return;
+		++counters.batches;
+		counters.operations += batch.size();
+
+		bool batched = false;
+		if (batch.size() > 1) {
+			// hash and prefetch the whole batch; this answers the lookups
+			// and warms the chains the writes are about to walk. If the
+			// hasher, a key copy or an allocation throws, the batch runs
+			// one operation at a time instead, so that only the operations
+			// at fault see the exception
+			try {
+				for (size_t i = 0; i < batch.size(); ++i) keys.push_back(*batch[i]->key);
+				found.resize(batch.size());
+				map.find_batch(keys.data(), keys.size(), found.data());
+				batched = true;
+			} catch (...) {
+				batched = false;
+			}
+			// only a hint: an insert that needs the room allocates it
+			// itself, and reports the failure to its own caller
+			try {
+				if (inserts > 1) map.reserve(map.size() + inserts);
+			} catch (...) {
+				// nothing reserved; the table is unchanged
+			}
+		}
+		// lookups before writes, so the entries found are still valid
+		for (size_t i = 0; i < batch.size(); ++i) {
+			Slot &slot = *batch[i];
+			if (slot.op != FIND) continue;
+			try {
+				const typename map_type::value_type *entry;
+				if (batched) {
+					entry = found[i];
+				} else {
+					typename map_type::const_iterator it = static_cast<const map_type &>(map).find(*slot.key);
+					entry = it == map.cend() ? nullptr : &*it;
+				}
+				slot.result = entry != nullptr;
+				if (entry) *slot.out = entry->second;
+			} catch (...) {
+				slot.error = std::current_exception();
+			}
+		}
+		for (size_t i = 0; i < batch.size(); ++i) {
+			if (batch[i]->op == FIND) continue;
+			try {
+				write(*batch[i]);
+			} catch (...) {
+				batch[i]->error = std::current_exception();
+			}
+		}
+		for (size_t i = 0; i < batch.size(); ++i) batch[i]->state.store(DONE, std::memory_order_release);
+	}
+
+	bool submit(size_t thread, int op, const Key &key, const T *in, T *out) {
+		if (thread >= slots.size()) throw index_out_of_bound();
+		Slot &slot = slots[thread];
+		slot.op = op;
+		slot.key = &key;
+		slot.in = in;
+		slot.out = out;
+		slot.state.store(PENDING, std::memory_order_release);
+		while (slot.state.load(std::memory_order_acquire) != DONE) {
+			if (lock.try_lock()) {
+				try {
+					combine();
+				} catch (...) {
+					lock.unlock();
+					throw;
+				}
+				lock.unlock();
+			} else {
+				std::this_thread::yield();
+			}
+		}
+		slot.state.store(IDLE, std::memory_order_relaxed);
+		if (slot.error) {
+			std::exception_ptr error = slot.error;
+			slot.error = nullptr;
+			std::rethrow_exception(error);
+		}
+		return slot.result;
+	}
+
+public:
+	/**
+	 * threads is the number of slots: calls pass a slot number below it.
+	 */
+	explicit flat_combining_map(size_t threads) : slots(threads), counters() {
+		if (threads == 0) throw runtime_error();
+		batch.reserve(threads);
+		keys.reserve(threads);
+		found.reserve(threads);
+	}
+
+	flat_combining_map(const flat_combining_map &) = delete;
+	flat_combining_map & operator=(const flat_combining_map &) = delete;
+
+	/**
+	 * copies the value of key into value and returns true, or returns
+	 *   false.
+	 */
+	bool find(size_t thread, const Key &key, T &value) {
+		return submit(thread, FIND, key, nullptr, &value);
+	}
+
+	/**
+	 * inserts key with value unless present; returns whether it did.
+	 */
+	bool insert(size_t thread, const Key &key, const T &value) {
+		return submit(thread, INSERT, key, &value, nullptr);
+	}
+
+	/**
+	 * inserts key with value or overwrites its value; returns whether it
+	 *   inserted.
+	 */
+	bool assign(size_t thread, const Key &key, const T &value) {
+		return submit(thread, ASSIGN, key, &value, nullptr);
+	}
+
+	/**
+	 * erases key; returns whether it was present.
+	 */
+	bool erase(size_t thread, const Key &key) {
+		return submit(thread, ERASE, key, nullptr, nullptr);
+	}
+
+	/**
+	 * calls fn(map) with the map locked; fn must not call back into this
+	 *   wrapper.
+	 */
+	template<class F>
+	void visit(F fn) {
+		std::lock_guard<std::mutex> guard(lock);
+		fn(static_cast<const map_type &>(map));
+	}
+
+	size_t size() {
+		std::lock_guard<std::mutex> guard(lock);
+		return map.size();
+	}
+
+	// batches combined so far and the operations they held
+	combining_stats stats() {
+		std::lock_guard<std::mutex> guard(lock);
+		return counters;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * approximate access counts for the admission policy of the caches in
+ * cache.hpp (TinyLFU, Einziger, Friedman & Manes).
+ *
+ * A count-min sketch of 4-bit counters, sixteen to a 64-bit word: a key
+ * increments one counter in each of four rows and its estimate is the
+ * least of the four. After ten times the sized-for number of increments
+ * every counter is halved, so the counts follow the recent popularity
+ * of a key and not its whole history.
+ */
+#ifndef SJTU_FREQUENCY_SKETCH_HPP
+#define SJTU_FREQUENCY_SKETCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sjtu {
+namespace detail {
+
+class frequency_sketch {
+public:
+	static const unsigned MAX_COUNT = 15;
+
+private:
+	std::vector<std::uint64_t> words;
+	size_t additions;
+	size_t sample_size;
+
+	// hashes of integers may be the identity; spread every bit first
+	static std::uint64_t mix(size_t hash) {
+		std::uint64_t x = hash;
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdull;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ull;
+		x ^= x >> 33;
+		return x;
+	}
+
+	// the word and the bit offset of the counter of row i
+	void locate(std::uint64_t x, int i, size_t &word, unsigned &shift) const {
+		static const std::uint64_t seed[4] = {
+			0xc3a5c85c97cb3127ull, 0xb492b66fbe98f273ull, 0x9ae16a3b2f90404full, 0xcbf29ce484222325ull
+		};
+		std::uint64_t h = (x + seed[i]) * seed[i];
+		h += h >> 32;
+		word = (size_t)h & (words.size() - 1);
+		shift = (unsigned)(h >> 60) << 2;
+	}
+
+	// halves every counter
+	void age() {
+		for (size_t i = 0; i < words.size(); ++i) {
+			words[i] = (words[i] >> 1) & 0x7777777777777777ull;
+		}
+		additions >>= 1;
+	}
+
+public:
+	frequency_sketch() : additions(0), sample_size(0) {}
+
+	/**
+	 * empties the sketch and sizes it for a cache of capacity entries.
+	 */
+	void reset(size_t capacity) {
+		size_t count = 1;
+		while (count < capacity) count <<= 1;
+		words.assign(count, 0);
+		additions = 0;
+		sample_size = 10 * capacity;
+	}
+
+	void release() {
+		std::vector<std::uint64_t>().swap(words);
+		additions = sample_size = 0;
+	}
+
+	bool empty() const {
+		return words.empty();
+	}
+
+	/**
+	 * counts one access to the key with this hash.
+	 */
+	void add(size_t hash) {
+		std::uint64_t x = mix(hash);
+		bool added = false;
+		for (int i = 0; i < 4; ++i) {
+			size_t word;
+			unsigned shift;
+			locate(x, i, word, shift);
+			if (((words[word] >> shift) & MAX_COUNT) != MAX_COUNT) {
+				words[word] += (std::uint64_t)1 << shift;
+				added = true;
+			}
+		}
+		if (added && ++additions >= sample_size) age();
+	}
+
+	/**
+	 * the estimated number of recent accesses to the key with this hash,
+	 *   at most MAX_COUNT; never below the true count since the last aging.
+	 */
+	unsigned estimate(size_t hash) const {
+		std::uint64_t x = mix(hash);
+		unsigned count = MAX_COUNT;
+		for (int i = 0; i < 4; ++i) {
+			size_t word;
+			unsigned shift;
+			locate(x, i, word, shift);
+			unsigned c = (unsigned)(words[word] >> shift) & MAX_COUNT;
+			if (c < count) count = c;
+		}
+		return count;
+	}
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,220 @@
+/**
+ * insertion-ordered group-by aggregation over linked_hashmap.
+ *
+ *   sjtu::group_by<std::string, long long> report;
+ *   for (...) report.add(region, amount);
+ *   for (auto it = report.groups().cbegin(); it != report.groups().cend(); ++it)
+ *       print(it->first, it->second.count, it->second.sum);
+ *
+ * Groups come out in the order their keys were first seen. Each row costs
+ * one hash probe: linked_hashmap::try_emplace() either finds the group or
+ * appends a fresh aggregate, and the row is added to it in place.
+ *
+ * An Aggregate is any default-constructible type with
+ *   void add(const Value &value);
+ *   void merge(const Aggregate &other);   // other covers later rows
+ * basic_aggregate (count, sum, min, max) is the default.
+ *
+ * add_parallel() aggregates a random-access range on a thread_pool and
+ * gives the same groups, in the same order, as add() row by row.
+ */
+#ifndef SJTU_GROUP_BY_HPP
+#define SJTU_GROUP_BY_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "linked_hashmap.hpp"
+#include "thread_pool.hpp"
+
+namespace sjtu {
+
+template<class Value>
+struct basic_aggregate {
+	size_t count;
+	Value sum;
+	Value min;
+	Value max;
+
+	basic_aggregate() : count(0), sum(), min(), max() {}
+
+	void add(const Value &value) {
+		if (count == 0) {
+			min = max = value;
+		} else {
+			if (value < min) min = value;
+			if (max < value) max = value;
+		}
+		sum += value;
+		++count;
+	}
+
+	void merge(const basic_aggregate &other) {
+		if (other.count == 0) return;
+		if (count == 0) {
+			*this = other;
+			return;
+		}
+		if (other.min < min) min = other.min;
+		if (max < other.max) max = other.max;
+		sum += other.sum;
+		count += other.count;
+	}
+};
+
+template<class Key, class Value, class Aggregate = basic_aggregate<Value>,
+         class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class group_by {
+public:
+	typedef linked_hashmap<Key, Aggregate, Hash, Equal> map_type;
+
+private:
+	// a partial aggregate and where its key was first seen: the chunk,
+	// then the position among that chunk's groups
+	struct Tagged {
+		Aggregate aggregate;
+		size_t chunk;
+		size_t position;
+	};
+	typedef linked_hashmap<Key, Tagged, Hash, Equal> tagged_map;
+
+	// a group of a chunk's private map and its position in that map
+	struct Partial {
+		typename map_type::value_type *group;
+		size_t position;
+	};
+
+	map_type table;
+
+	void add_group(const Key &key, Aggregate &&aggregate) {
+		pair<typename map_type::iterator, bool> found = table.try_emplace(key, std::move(aggregate));
+		if (!found.second) found.first->second.merge(aggregate);
+	}
+
+public:
+	/**
+	 * adds one row to the group of key.
+	 */
+	void add(const Key &key, const Value &value) {
+		table.try_emplace(key).first->second.add(value);
+	}
+
+	/**
+	 * adds key_of(row), value_of(row) for every row in [first, last).
+	 */
+	template<class InputIt, class KeyOf, class ValueOf>
+	void add(InputIt first, InputIt last, KeyOf key_of, ValueOf value_of) {
+		for (; first != last; ++first) add(key_of(*first), value_of(*first));
+	}
+
+	/**
+	 * add() over [first, last) in parallel on pool, with the same result.
+	 * The range is cut into one chunk per thread, each aggregated into a
+	 *   private map. The partial aggregates are then merged in parallel,
+	 *   one hash partition of the keys per thread (by the hash the private
+	 *   map cached, see linked_hashmap::hash_of()), each partition taking
+	 *   the chunks in order; every merged group keeps the chunk and the
+	 *   position its key was first seen at. Last, the partitions are
+	 *   interleaved into groups() by that tag, which restores the global
+	 *   first-seen order. Only this final step is sequential, and it costs
+	 *   one probe per distinct key, not per row.
+	 * key_of and value_of are called concurrently.
+	 */
+	template<class RandomIt, class KeyOf, class ValueOf>
+	void add_parallel(RandomIt first, RandomIt last, KeyOf key_of, ValueOf value_of, thread_pool &pool) {
+		size_t n = (size_t)(last - first);
+		size_t chunks = pool.size();
+		if (chunks <= 1 || n < chunks) {
+			add(first, last, key_of, value_of);
+			return;
+		}
+		size_t parts = chunks;
+
+		// aggregate each chunk; sort its groups into the partitions
+		std::vector<map_type> local(chunks);
+		std::vector<std::vector<std::vector<Partial> > > split(chunks);
+		pool.run(chunks, [&](size_t c) {
+			RandomIt begin = first + (std::ptrdiff_t)(n * c / chunks);
+			RandomIt end = first + (std::ptrdiff_t)(n * (c + 1) / chunks);
+			map_type &groups = local[c];
+			for (RandomIt row = begin; row != end; ++row) {
+				groups.try_emplace(key_of(*row)).first->second.add(value_of(*row));
+			}
+			split[c].resize(parts);
+			size_t position = 0;
+			for (typename map_type::iterator it = groups.begin(); it != groups.end(); ++it) {
+				split[c][groups.hash_of(it) % parts].push_back(Partial{&*it, position++});
+			}
+		});
+
+		// merge each partition over the chunks in order
+		std::vector<tagged_map> merged(parts);
+		pool.run(parts, [&](size_t p) {
+			tagged_map &groups = merged[p];
+			for (size_t c = 0; c < chunks; ++c) {
+				const std::vector<Partial> &mine = split[c][p];
+				for (size_t i = 0; i < mine.size(); ++i) {
+					typename map_type::value_type *group = mine[i].group;
+					pair<typename tagged_map::iterator, bool> found = groups.try_emplace(group->first);
+					if (found.second) {
+						found.first->second.aggregate = std::move(group->second);
+						found.first->second.chunk = c;
+						found.first->second.position = mine[i].position;
+					} else {
+						found.first->second.aggregate.merge(group->second);
+					}
+				}
+			}
+		});
+
+		// every partition is ordered by its tags; interleave them
+		std::vector<typename tagged_map::iterator> head(parts);
+		for (size_t p = 0; p < parts; ++p) head[p] = merged[p].begin();
+		for (;;) {
+			size_t best = parts;
+			for (size_t p = 0; p < parts; ++p) {
+				if (head[p] == merged[p].end()) continue;
+				if (best == parts || head[p]->second.chunk < head[best]->second.chunk ||
+				    (head[p]->second.chunk == head[best]->second.chunk &&
+				     head[p]->second.position < head[best]->second.position)) {
+					best = p;
+				}
+			}
+			if (best == parts) break;
+			add_group(head[best]->first, std::move(head[best]->second.aggregate));
+			++head[best];
+		}
+	}
+
+	/**
+	 * merges the groups of other, as if its rows had been added after
+	 *   those of this one.
+	 */
+	void merge(const group_by &other) {
+		for (typename map_type::const_iterator it = other.table.cbegin(); it != other.table.cend(); ++it) {
+			pair<typename map_type::iterator, bool> found = table.try_emplace(it->first, it->second);
+			if (!found.second) found.first->second.merge(it->second);
+		}
+	}
+
+	/**
+	 * the groups in first-seen order.
+	 */
+	const map_type & groups() const {
+		return table;
+	}
+
+	size_t size() const {
+		return table.size();
+	}
+
+	void clear() {
+		table.clear();
+	}
+};
+
+}
+
+#endif
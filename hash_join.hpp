@@ -0,0 +1,142 @@
+/**
+ * hash join with linked_hashmap as the build side.
+ *
+ *   sjtu::hash_join<long long, order> join;
+ *   join.build(orders.begin(), orders.end(), [](const order &o) { return o.customer; });
+ *   join.probe(customers.begin(), customers.end(),
+ *              [](const customer &c) { return c.id; },
+ *              [&](const customer &c, const order &o) { ... });
+ *
+ * build() copies the rows into the join. The first row of a key is kept
+ * in the map entry itself, so probing a key with one row touches nothing
+ * but the entry. With duplicates allowed (the default) the later rows of
+ * a key are chained in build order in a side array; otherwise the first
+ * row of each key wins, as with linked_hashmap::insert().
+ * probe() looks the probe keys up in batches through find_batch(), which
+ * hashes a whole batch and prefetches its slots before walking any chain,
+ * and calls emit(probe_row, build_row) for every match in probe order,
+ * the build rows of one key in build order.
+ */
+#ifndef SJTU_HASH_JOIN_HPP
+#define SJTU_HASH_JOIN_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+namespace sjtu {
+
+template<class Key, class Row, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class hash_join {
+public:
+	// probe keys looked up per find_batch() call
+	static const size_t BATCH_SIZE = 64;
+
+private:
+	static constexpr size_t NONE = (size_t)-1;
+
+	// the first build row of a key, and where its later rows are in more
+	struct Chain {
+		Row row;
+		size_t second;
+		size_t last;
+
+		explicit Chain(const Row &row) : row(row), second(NONE), last(NONE) {}
+	};
+	typedef linked_hashmap<Key, Chain, Hash, Equal> map_type;
+
+	map_type table;
+	std::vector<Row> more;     // the build rows after the first of their key
+	std::vector<size_t> next;  // the next row in more with the same key, or NONE
+	size_t row_count;
+	bool duplicates;
+
+public:
+	explicit hash_join(bool allow_duplicates = true) : row_count(0), duplicates(allow_duplicates) {}
+
+	/**
+	 * adds the rows in [first, last) to the build side, keyed by
+	 *   key_of(row); may be called more than once.
+	 */
+	template<class InputIt, class KeyOf>
+	void build(InputIt first, InputIt last, KeyOf key_of) {
+		typedef typename std::iterator_traits<InputIt>::iterator_category category;
+		if (std::is_base_of<std::forward_iterator_tag, category>::value) {
+			table.reserve(table.size() + (size_t)std::distance(first, last));
+		}
+		for (; first != last; ++first) {
+			// one probe: the row is only copied in if the key is new
+			pair<typename map_type::iterator, bool> inserted = table.try_emplace(key_of(*first), *first);
+			if (!inserted.second) {
+				if (!duplicates) continue;
+				Chain &chain = inserted.first->second;
+				size_t row = more.size();
+				more.push_back(*first);
+				next.push_back(NONE);
+				if (chain.last == NONE) chain.second = row;
+				else next[chain.last] = row;
+				chain.last = row;
+			}
+			++row_count;
+		}
+	}
+
+	/**
+	 * joins the rows in [first, last) with the build side, calling
+	 *   emit(probe_row, build_row) for each match; returns the number of
+	 *   matches.
+	 */
+	template<class ForwardIt, class KeyOf, class Emit>
+	size_t probe(ForwardIt first, ForwardIt last, KeyOf key_of, Emit emit) const {
+		typedef typename map_type::value_type entry;
+		std::vector<Key> keys;
+		keys.reserve(BATCH_SIZE);
+		ForwardIt batch[BATCH_SIZE];
+		const entry *found[BATCH_SIZE];
+		size_t matches = 0;
+		while (first != last) {
+			keys.clear();
+			size_t m = 0;
+			for (; m < BATCH_SIZE && first != last; ++m, ++first) {
+				batch[m] = first;
+				keys.push_back(key_of(*first));
+			}
+			table.find_batch(keys.data(), m, found);
+			for (size_t i = 0; i < m; ++i) {
+				if (!found[i]) continue;
+				const Chain &chain = found[i]->second;
+				emit(*batch[i], chain.row);
+				++matches;
+				for (size_t row = chain.second; row != NONE; row = next[row]) {
+					emit(*batch[i], more[row]);
+					++matches;
+				}
+			}
+		}
+		return matches;
+	}
+
+	// the number of distinct build keys
+	size_t key_count() const {
+		return table.size();
+	}
+
+	// the number of build rows kept
+	size_t size() const {
+		return row_count;
+	}
+
+	void clear() {
+		table.clear();
+		more.clear();
+		next.clear();
+		row_count = 0;
+	}
+};
+
+}
+
+#endif
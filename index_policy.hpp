@@ -0,0 +1,118 @@
+/**
+ * bucket indexing policies for linked_hashmap.
+ *
+ * A policy maps a hash value to a bucket index and decides which bucket
+ * counts the table may use. Both policies below avoid the integer
+ * division of 'hash % buckets':
+ *
+ *   pow2_index  - power-of-two bucket counts; the hash is multiplied by
+ *                 2^64 / phi and the top bits are taken (Fibonacci
+ *                 hashing), so identity hashes of integers still spread.
+ *   prime_index - prime bucket counts reduced with a precomputed
+ *                 reciprocal (Lemire's fastmod); for hash functions whose
+ *                 values share low or high bits, where only a prime
+ *                 modulus spreads them.
+ *
+ * A policy provides:
+ *   static size_t round_up(size_t n);   smallest usable bucket count >= n
+ *   static size_t grow(size_t n);       bucket count to grow to from n
+ *   void reset(size_t buckets);         prepare for a table of that size
+ *   size_t operator()(size_t hash);     bucket index of a hash value
+ *   void index_integers(const Int *keys, size_t n, size_t *out);
+ *       bucket indices of integers used as their own hash values
+ */
+#ifndef SJTU_INDEX_POLICY_HPP
+#define SJTU_INDEX_POLICY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "batch_hash.hpp"
+
+namespace sjtu {
+
+class pow2_index {
+private:
+	unsigned shift;
+
+public:
+	pow2_index() : shift(64) {}
+
+	static size_t round_up(size_t n) {
+		size_t buckets = 2;
+		while (buckets < n) buckets <<= 1;
+		return buckets;
+	}
+
+	static size_t grow(size_t buckets) {
+		return buckets * 2;
+	}
+
+	void reset(size_t buckets) {
+		unsigned bits = 0;
+		while (((size_t)1 << bits) < buckets) ++bits;
+		shift = 64 - bits;
+	}
+
+	size_t operator()(size_t hash) const {
+		return (size_t)(((std::uint64_t)hash * detail::FIBONACCI_MULTIPLIER) >> shift);
+	}
+
+	template<class Int>
+	void index_integers(const Int *keys, size_t n, size_t *out) const {
+		detail::batch_fibonacci_index(keys, n, shift, out);
+	}
+};
+
+class prime_index {
+private:
+	std::uint32_t divisor;
+	std::uint64_t reciprocal;
+
+	static const std::uint32_t *primes(size_t &count) {
+		static const std::uint32_t table[] = {
+			29u, 53u, 97u, 193u, 389u, 769u, 1543u, 3079u, 6151u, 12289u,
+			24593u, 49157u, 98317u, 196613u, 393241u, 786433u, 1572869u,
+			3145739u, 6291469u, 12582917u, 25165843u, 50331653u, 100663319u,
+			201326611u, 402653189u, 805306457u, 1610612741u, 3221225473u
+		};
+		count = sizeof(table) / sizeof(table[0]);
+		return table;
+	}
+
+public:
+	prime_index() : divisor(1), reciprocal(0) {}
+
+	// the largest prime is returned for anything beyond the table
+	static size_t round_up(size_t n) {
+		size_t count;
+		const std::uint32_t *p = primes(count);
+		for (size_t i = 0; i < count; ++i) {
+			if (p[i] >= n) return p[i];
+		}
+		return p[count - 1];
+	}
+
+	static size_t grow(size_t buckets) {
+		return round_up(buckets + 1);
+	}
+
+	void reset(size_t buckets) {
+		divisor = (std::uint32_t)buckets;
+		reciprocal = ~(std::uint64_t)0 / divisor + 1;
+	}
+
+	// the reduction works on 32 bits; the upper half of the hash is
+	// folded in first
+	size_t operator()(size_t hash) const {
+		return detail::fastmod_index(hash, divisor, reciprocal);
+	}
+
+	template<class Int>
+	void index_integers(const Int *keys, size_t n, size_t *out) const {
+		detail::batch_fastmod_index(keys, n, divisor, reciprocal, out);
+	}
+};
+
+}
+
+#endif
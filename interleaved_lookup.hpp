@@ -0,0 +1,159 @@
+/**
+ * interleaved (coroutine-based) lookups over sjtu::linked_hashmap.
+ *
+ * A single find() on a map much larger than the last-level cache is a
+ * chain of dependent misses: bucket slot -> Node (which holds its
+ * Bucket) -> entry.
+ * interleaved_lookup runs a group of lookups as coroutines, each of which
+ * prefetches the next address it needs and suspends; the scheduler then
+ * resumes the other lookups in the group, so their misses overlap instead
+ * of being served one after another.
+ *
+ * Requires C++20 coroutines.
+ */
+#ifndef SJTU_INTERLEAVED_LOOKUP_HPP
+#define SJTU_INTERLEAVED_LOOKUP_HPP
+
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+#error "interleaved_lookup.hpp requires C++20 coroutine support"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+namespace sjtu {
+
+template<class Map>
+class interleaved_lookup {
+public:
+	typedef typename Map::value_type value_type;
+	typedef typename Map::key_type key_type;
+
+	static const size_t DEFAULT_GROUP_SIZE = 16;
+
+private:
+	// a lookup coroutine; resumed by the scheduler until it is done.
+	struct task {
+		struct promise_type {
+			std::exception_ptr error;
+
+			task get_return_object() {
+				return task(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept { error = std::current_exception(); }
+		};
+
+		std::coroutine_handle<promise_type> handle;
+
+		explicit task(std::coroutine_handle<promise_type> h) : handle(h) {}
+		task(task &&other) noexcept : handle(other.handle) { other.handle = nullptr; }
+		task(const task &) = delete;
+		task & operator=(const task &) = delete;
+		~task() {
+			if (handle) handle.destroy();
+		}
+	};
+
+	const Map *map;
+	size_t group_size;
+
+	// shared work queue of the current run
+	const key_type *keys;
+	const value_type **results;
+	size_t count;
+	size_t cursor;
+
+	static void prefetch(const void *addr) {
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(addr);
+#else
+		(void)addr;
+#endif
+	}
+
+	// Each worker keeps pulling keys off the shared cursor, so a run only
+	// allocates group_size coroutine frames however many keys it serves.
+	// Every dependent load is preceded by a prefetch and a suspension.
+	task worker() {
+		while (cursor < count) {
+			size_t i = cursor++;
+			const key_type &key = keys[i];
+
+			size_t hash = map->hasher(key);
+			typename Map::Bucket *const *slot = map->table + map->indexer(hash);
+			prefetch(slot);
+			co_await std::suspend_always{};
+
+			const value_type *found = nullptr;
+			typename Map::Bucket *bucket = *slot;
+			while (bucket) {
+				prefetch(bucket);
+				co_await std::suspend_always{};
+				// the cached hash rejects most other keys without the entry
+				if (bucket->hash == hash) {
+					const value_type *entry = bucket->node->data;
+					prefetch(entry);
+					co_await std::suspend_always{};
+					if (map->equal(entry->first, key)) {
+						found = entry;
+						break;
+					}
+				}
+				bucket = bucket->next;
+			}
+			results[i] = found;
+		}
+	}
+
+public:
+	/**
+	 * group_size is the number of lookups kept in flight at once.
+	 * The map must not be modified while a lookup is running.
+	 */
+	explicit interleaved_lookup(const Map &m, size_t group = DEFAULT_GROUP_SIZE)
+		: map(&m), group_size(group ? group : 1),
+		  keys(nullptr), results(nullptr), count(0), cursor(0) {}
+
+	/**
+	 * looks up keys[0, n) and stores a pointer to the matching entry
+	 * (or nullptr if the key is absent) in results[i].
+	 */
+	void find(const key_type *k, size_t n, const value_type **out) {
+		keys = k;
+		results = out;
+		count = n;
+		cursor = 0;
+
+		size_t width = n < group_size ? n : group_size;
+		std::vector<task> tasks;
+		tasks.reserve(width);
+		for (size_t i = 0; i < width; ++i) {
+			tasks.push_back(worker());
+		}
+
+		size_t live = width;
+		while (live) {
+			for (size_t i = 0; i < width; ++i) {
+				auto handle = tasks[i].handle;
+				if (handle.done()) continue;
+				handle.resume();
+				if (handle.done()) {
+					--live;
+					if (handle.promise().error) {
+						std::rethrow_exception(handle.promise().error);
+					}
+				}
+			}
+		}
+	}
+};
+
+}
+
+#endif
@@ -5,12 +5,33 @@
 #define SJTU_LINKEDHASHMAP_HPP
 
 // only for std::equal_to<T> and std::hash<T>
+#include <algorithm>
 #include <functional>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "utility.hpp"
 #include "exceptions.hpp"
+#include "index_policy.hpp"
+#include "miss_filter.hpp"
+#include "thread_pool.hpp"
 
 namespace sjtu {
+
+template<class Map> class interleaved_lookup;
+
     /**
      * In linked_hashmap, iteration ordering is differ from map,
      * which is the order in which keys were inserted into the map.
@@ -21,11 +42,25 @@ namespace sjtu {
      * into the map.
      */
 
+    /**
+     * IndexPolicy maps hash values to buckets and picks the bucket counts,
+     * see index_policy.hpp. Neither policy divides on lookup. The default
+     * prime_index keeps dense integer keys like those of data/ free of
+     * collisions; pow2_index is the cheaper reduction for well-mixed
+     * hashes.
+     *
+     * Allocator provides the memory of the entries, buckets and table;
+     * it is rebound to each internal type. The entries are constructed
+     * in place, so the allocator is not passed on to Key and T. See
+     * sjtu::pmr::linked_hashmap for maps living in a memory_resource.
+     */
 template<
 	class Key,
 	class T,
 	class Hash = std::hash<Key>,
-	class Equal = std::equal_to<Key>
+	class Equal = std::equal_to<Key>,
+	class IndexPolicy = prime_index,
+	class Allocator = std::allocator<pair<const Key, T> >
 > class linked_hashmap {
 public:
 	/**
@@ -34,28 +69,222 @@ public:
 	 * You can use sjtu::linked_hashmap as value_type by typedef.
 	 */
 	typedef pair<const Key, T> value_type;
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef Allocator allocator_type;
 
 private:
-	// Node structure for doubly-linked list
+	typedef std::allocator_traits<Allocator> alloc_traits;
+	template<class U> using rebind_alloc = typename alloc_traits::template rebind_alloc<U>;
+	template<class U> using rebind_traits = std::allocator_traits<rebind_alloc<U> >;
+
+	static_assert(std::is_same<typename alloc_traits::pointer, typename alloc_traits::value_type *>::value,
+		"allocators with fancy pointers are not supported");
+
+	// raw storage for n objects of type U from alloc
+	template<class U>
+	static U * allocate(const Allocator &alloc, size_t n) {
+		rebind_alloc<U> a(alloc);
+		return rebind_traits<U>::allocate(a, n);
+	}
+
+	template<class U>
+	static void deallocate(const Allocator &alloc, U *p, size_t n) {
+		rebind_alloc<U> a(alloc);
+		rebind_traits<U>::deallocate(a, p, n);
+	}
+
+	template<class U, class... Args>
+	static U * new_object(const Allocator &alloc, Args &&... args) {
+		U *p = allocate<U>(alloc, 1);
+		try {
+			return new (p) U(std::forward<Args>(args)...);
+		} catch (...) {
+			deallocate(alloc, p, 1);
+			throw;
+		}
+	}
+
+	template<class U>
+	static void delete_object(const Allocator &alloc, U *p) {
+		p->~U();
+		deallocate(alloc, p, 1);
+	}
+
+	struct Node;
+
+	// Hash table bucket structure. The full hash of the key is kept, so
+	// that chain hops compare it before loading the entry, and rehashing
+	// never calls the hash function again.
+	struct Bucket {
+		Node *node;
+		Bucket *next;
+		size_t hash;
+
+		Bucket() : node(nullptr), next(nullptr), hash(0) {}
+		Bucket(Node *n) : node(n), next(nullptr), hash(0) {}
+	};
+
+	// Node structure for doubly-linked list. Every node carries the bucket
+	// chaining it into the table, so the table owns no memory of its own
+	// beyond the slot array; a node is 64 bytes on 64-bit targets, and
+	// bucket and data share a cache line.
 	struct Node {
+		Bucket bucket;  // bucket.node == this
 		value_type *data;
 		Node *prev;
 		Node *next;
+		unsigned char *live;  // the slab's liveness byte for data
+		bool split;  // listed in splits
 
-		Node() : data(nullptr), prev(nullptr), next(nullptr) {}
-		Node(const value_type &val) : data(new value_type(val)), prev(nullptr), next(nullptr) {}
-		~Node() {
-			if (data) delete data;
-		}
+		Node() : bucket(this), data(nullptr), prev(nullptr), next(nullptr), live(nullptr), split(false) {}
 	};
 
-	// Hash table bucket structure
-	struct Bucket {
-		Node *node;
-		Bucket *next;
+	// A slab of entries: the values sit in one array beside a liveness
+	// byte per slot, so whole-map aggregates scan them without the list.
+	struct Slab {
+		Slab *next;
+		size_t capacity;
+		Node *nodes;
+		value_type *values;
+		unsigned char *live;
+	};
 
-		Bucket() : node(nullptr), next(nullptr) {}
-		Bucket(Node *n) : node(n), next(nullptr) {}
+	// Hands out Nodes with constructed values from a chain of slabs, which
+	// grow geometrically from MIN_SLAB to MAX_SLAB entries. Every map
+	// stores its entries this way; there is no per-node allocation mode.
+	class NodePool {
+	private:
+		Allocator alloc;
+		Slab *slabs;
+		Node *free_list;
+		size_t next_capacity;
+
+		void grow() {
+			size_t cap = next_capacity;
+			Slab *slab = new_object<Slab>(alloc, Slab{nullptr, cap, nullptr, nullptr, nullptr});
+			try {
+				slab->nodes = allocate<Node>(alloc, cap);
+				slab->values = allocate<value_type>(alloc, cap);
+				slab->live = allocate<unsigned char>(alloc, cap);
+			} catch (...) {
+				free_slab(slab);
+				throw;
+			}
+			// dead slots read as zero to the branch-free aggregates
+			std::memset(static_cast<void *>(slab->values), 0, cap * sizeof(value_type));
+			std::memset(slab->live, 0, cap);
+			for (size_t i = 0; i < cap; ++i) {
+				Node *node = new (slab->nodes + i) Node();
+				node->data = slab->values + i;
+				node->live = slab->live + i;
+			}
+			slab->next = slabs;
+			slabs = slab;
+			if (next_capacity < MAX_SLAB) next_capacity *= 2;
+			for (size_t i = slab->capacity; i-- > 0; ) {
+				slab->nodes[i].next = free_list;
+				free_list = slab->nodes + i;
+			}
+		}
+
+		// Node is trivially destructible, so the arrays are just freed
+		void free_slab(Slab *slab) {
+			if (slab->live) deallocate(alloc, slab->live, slab->capacity);
+			if (slab->values) deallocate(alloc, slab->values, slab->capacity);
+			if (slab->nodes) deallocate(alloc, slab->nodes, slab->capacity);
+			delete_object(alloc, slab);
+		}
+
+	public:
+		explicit NodePool(const Allocator &a)
+			: alloc(a), slabs(nullptr), free_list(nullptr), next_capacity(MIN_SLAB) {}
+		NodePool(NodePool &&other) noexcept
+			: alloc(other.alloc), slabs(other.slabs), free_list(other.free_list),
+			  next_capacity(other.next_capacity) {
+			other.slabs = nullptr;
+			other.free_list = nullptr;
+			other.next_capacity = MIN_SLAB;
+		}
+		NodePool(const NodePool &) = delete;
+		NodePool & operator=(const NodePool &) = delete;
+		~NodePool() {
+			release();
+		}
+
+		template<class... Args>
+		Node * create(Args &&... args) {
+			if (!free_list) grow();
+			Node *node = free_list;
+			new (node->data) value_type(std::forward<Args>(args)...);
+			free_list = node->next;
+			*node->live = 1;
+			node->prev = node->next = nullptr;
+			node->split = false;
+			return node;
+		}
+
+		void destroy(Node *node) {
+			node->data->~value_type();
+			*node->live = 0;
+			node->next = free_list;
+			free_list = node;
+		}
+
+		// destroys every live value and frees all slabs; trivially
+		// destructible entries are not visited at all
+		void release() {
+			while (slabs) {
+				Slab *next = slabs->next;
+				if constexpr (!std::is_trivially_destructible<value_type>::value) {
+					for (size_t i = 0; i < slabs->capacity; ++i) {
+						if (slabs->live[i]) slabs->values[i].~value_type();
+					}
+				}
+				free_slab(slabs);
+				slabs = next;
+			}
+			free_list = nullptr;
+			next_capacity = MIN_SLAB;
+		}
+
+		const Allocator & get_allocator() const {
+			return alloc;
+		}
+
+		// only while the pool holds no slabs
+		void set_allocator(const Allocator &a) {
+			alloc = a;
+		}
+
+		// takes over the slabs and free nodes of other, which must use an
+		// allocator equal to this one
+		void splice(NodePool &other) {
+			if (other.slabs) {
+				Slab *last = other.slabs;
+				while (last->next) last = last->next;
+				last->next = slabs;
+				slabs = other.slabs;
+			}
+			if (other.free_list) {
+				Node *last = other.free_list;
+				while (last->next) last = last->next;
+				last->next = free_list;
+				free_list = other.free_list;
+			}
+			if (other.next_capacity > next_capacity) next_capacity = other.next_capacity;
+			other.slabs = nullptr;
+			other.free_list = nullptr;
+			other.next_capacity = MIN_SLAB;
+		}
+
+		// calls fn(values, live, capacity) for every slab
+		template<class F>
+		void for_each_slab(F fn) const {
+			for (const Slab *slab = slabs; slab; slab = slab->next) {
+				fn(static_cast<const value_type *>(slab->values), slab->live, slab->capacity);
+			}
+		}
 	};
 
 	// Hash table
@@ -66,80 +295,220 @@ private:
 	// Doubly-linked list for insertion order
 	Node *head;  // dummy head
 	Node *tail;  // dummy tail
+	NodePool nodes;
 
 	Hash hasher;
 	Equal equal;
+	IndexPolicy indexer;
+
+	// not owned; rehashes run on it once the map is large enough
+	thread_pool *rehash_pool;
+
+	// Optional Bloom filter over the keys, consulted before the table by
+	// single-key lookups; off while filter_bits (bits per key) is 0.
+	// Erased keys stay in it until it is rebuilt.
+	detail::blocked_bloom<Allocator> filter;
+	size_t filter_bits;
+	size_t filter_erased;
+
+	// Every SPLIT_STRIDE-th appended node, in list order; they cut the
+	// list into segments for the parallel algorithms. Erasing one of them
+	// marks the list dirty and the next parallel call rebuilds it, under
+	// splits_lock since the const ones may run on several threads at once.
+	mutable std::vector<Node*, rebind_alloc<Node*> > splits;
+	mutable size_t since_split;
+	mutable bool splits_dirty;
+	mutable std::mutex splits_lock;
+
+	// staged lookups walk the table directly, see interleaved_lookup.hpp
+	template<class Map> friend class interleaved_lookup;
 
 	static const size_t INITIAL_CAPACITY = 16;
 	static constexpr double LOAD_FACTOR = 1.5;
+	// keys handled per round by the batched lookup/insert paths
+	static const size_t BATCH_SIZE = 32;
+	// below this many elements the parallel paths are not worth the fork
+	static const size_t PARALLEL_MIN = 1 << 16;
+	// elements per segment of the parallel algorithms
+	static const size_t SPLIT_STRIDE = 4096;
+	// the parallel paths allocate from several threads at once, which
+	// only std::allocator is known to allow
+	static const bool CONCURRENT_ALLOCATOR = std::is_same<Allocator, std::allocator<value_type> >::value;
+	// entries per slab, first and largest
+	static const size_t MIN_SLAB = 16;
+	static const size_t MAX_SLAB = 1024;
 
 	// Helper functions
-	size_t get_bucket_index(const Key &key) const {
-		return hasher(key) % table_size;
+	void make_sentinels() {
+		head = new_object<Node>(nodes.get_allocator());
+		tail = new_object<Node>(nodes.get_allocator());
+		head->next = tail;
+		tail->prev = head;
+	}
+
+	void free_sentinels() {
+		delete_object(nodes.get_allocator(), head);
+		delete_object(nodes.get_allocator(), tail);
 	}
 
 	void init_table(size_t size) {
-		table_size = size;
-		table = new Bucket*[table_size];
+		table_size = IndexPolicy::round_up(size);
+		indexer.reset(table_size);
+		table = allocate<Bucket*>(nodes.get_allocator(), table_size);
 		for (size_t i = 0; i < table_size; ++i) {
 			table[i] = nullptr;
 		}
 	}
 
+	// the buckets live in the nodes, so only the slots are freed
 	void clear_table() {
 		if (table) {
-			for (size_t i = 0; i < table_size; ++i) {
-				Bucket *bucket = table[i];
-				while (bucket) {
-					Bucket *next = bucket->next;
-					delete bucket;
-					bucket = next;
-				}
-			}
-			delete[] table;
+			deallocate(nodes.get_allocator(), table, table_size);
 			table = nullptr;
 		}
 	}
 
 	void clear_list() {
-		Node *current = head->next;
-		while (current != tail) {
-			Node *next = current->next;
-			delete current;
-			current = next;
-		}
+		nodes.release();
 		head->next = tail;
 		tail->prev = head;
+		splits.clear();
+		since_split = 0;
+		splits_dirty = false;
+	}
+
+	void rebuild_splits() const {
+		splits.clear();
+		since_split = 0;
+		for (Node *node = head->next; node != tail; node = node->next) {
+			node->split = ++since_split == SPLIT_STRIDE;
+			if (node->split) {
+				splits.push_back(node);
+				since_split = 0;
+			}
+		}
+		splits_dirty = false;
+	}
+
+	// number of list segments, rebuilding the split points if needed.
+	// Only a mutation marks them dirty, so once one caller has rebuilt
+	// them the others just read
+	size_t segment_count() const {
+		std::lock_guard<std::mutex> guard(splits_lock);
+		if (splits_dirty) rebuild_splits();
+		return splits.size() + 1;
+	}
+
+	// calls fn(i, first, last) for every segment i = [first, last) of the
+	// list, spread over pool; segments are handed out one at a time
+	template<class F>
+	void for_each_segment(thread_pool &pool, F fn) const {
+		pool.run(segment_count(), [&](size_t i) {
+			Node *first = i == 0 ? head->next : splits[i - 1];
+			Node *last = i == splits.size() ? tail : splits[i];
+			fn(i, first, last);
+		});
 	}
 
 	void rehash() {
-		size_t new_size = table_size * 2;
-		Bucket **new_table = new Bucket*[new_size];
+		rehash_to(IndexPolicy::grow(table_size));
+	}
+
+	// moves every Bucket into a new table of new_size buckets;
+	// new_size must be a bucket count of IndexPolicy
+	void rehash_to(size_t new_size) {
+		if (new_size == table_size) return;
+		IndexPolicy new_indexer;
+		new_indexer.reset(new_size);
+		Bucket **new_table = allocate<Bucket*>(nodes.get_allocator(), new_size);
 		for (size_t i = 0; i < new_size; ++i) {
 			new_table[i] = nullptr;
 		}
 
-		// Rehash all elements
-		Node *current = head->next;
-		while (current != tail) {
-			size_t index = hasher(current->data->first) % new_size;
-			Bucket *new_bucket = new Bucket(current);
-			new_bucket->next = new_table[index];
-			new_table[index] = new_bucket;
-			current = current->next;
+		if (rehash_pool && rehash_pool->size() > 1 && element_count >= PARALLEL_MIN) {
+			relink_parallel(new_table, new_size, new_indexer);
+		} else {
+			for (size_t i = 0; i < table_size; ++i) {
+				Bucket *bucket = table[i];
+				while (bucket) {
+					Bucket *next = bucket->next;
+					size_t index = new_indexer(bucket->hash);
+					bucket->next = new_table[index];
+					new_table[index] = bucket;
+					bucket = next;
+				}
+			}
 		}
 
-		// Clean up old table
-		clear_table();
+		deallocate(nodes.get_allocator(), table, table_size);
 		table = new_table;
 		table_size = new_size;
+		indexer = new_indexer;
+		if (filter_bits) rebuild_filter();
 	}
 
-	Node* find_node(const Key &key) const {
-		size_t index = get_bucket_index(key);
+	// Two passes over rehash_pool, neither of which needs a lock:
+	// thread t splits the chains of old range t into one list per range
+	// of the new table, then thread d links every list bound for new
+	// range d into its buckets.
+	void relink_parallel(Bucket **new_table, size_t new_size, const IndexPolicy &new_indexer) {
+		size_t parts = rehash_pool->size();
+		size_t old_size = table_size;
+		std::vector<Bucket*> lists(parts * parts, nullptr);
+
+		rehash_pool->run(parts, [&](size_t t) {
+			std::vector<Bucket*> heads(parts, nullptr);
+			for (size_t i = old_size * t / parts; i < old_size * (t + 1) / parts; ++i) {
+				Bucket *bucket = table[i];
+				while (bucket) {
+					Bucket *next = bucket->next;
+					size_t part = new_indexer(bucket->hash) * parts / new_size;
+					bucket->next = heads[part];
+					heads[part] = bucket;
+					bucket = next;
+				}
+			}
+			for (size_t d = 0; d < parts; ++d) lists[t * parts + d] = heads[d];
+		});
+
+		rehash_pool->run(parts, [&](size_t d) {
+			for (size_t t = 0; t < parts; ++t) {
+				Bucket *bucket = lists[t * parts + d];
+				while (bucket) {
+					Bucket *next = bucket->next;
+					size_t index = new_indexer(bucket->hash);
+					bucket->next = new_table[index];
+					new_table[index] = bucket;
+					bucket = next;
+				}
+			}
+		});
+	}
+
+	// hash values and bucket indices of a batch of keys, the indices
+	// vectorized for integer keys
+	void get_bucket_indices(const Key *keys, size_t n, size_t *hashes, size_t *out) const {
+		if constexpr (detail::batch_hashable<Key, Hash>::value) {
+			for (size_t i = 0; i < n; ++i) hashes[i] = hasher(keys[i]);
+			indexer.index_integers(keys, n, out);
+		} else {
+			for (size_t i = 0; i < n; ++i) {
+				hashes[i] = hasher(keys[i]);
+				out[i] = indexer(hashes[i]);
+			}
+		}
+	}
+
+	void prefetch_bucket(size_t index) const {
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(table + index);
+#endif
+	}
+
+	Node* find_node(const Key &key, size_t hash, size_t index) const {
 		Bucket *bucket = table[index];
 		while (bucket) {
-			if (equal(bucket->node->data->first, key)) {
+			if (bucket->hash == hash && equal(bucket->node->data->first, key)) {
 				return bucket->node;
 			}
 			bucket = bucket->next;
@@ -147,42 +516,168 @@ private:
 		return nullptr;
 	}
 
+	Node* find_node(const Key &key, size_t hash) const {
+		if (filter_bits && !filter.may_contain(hash)) return nullptr;
+		return find_node(key, hash, indexer(hash));
+	}
+
+	Node* find_node(const Key &key) const {
+		return find_node(key, hasher(key));
+	}
+
+	// sizes the filter for the current table and adds every key
+	void rebuild_filter() {
+		filter.reset((size_t)(table_size * LOAD_FACTOR) + 1, filter_bits);
+		filter_erased = 0;
+		for (Node *node = head->next; node != tail; node = node->next) {
+			filter.add(node->bucket.hash);
+		}
+	}
+
 	void insert_to_list(Node *node) {
 		node->prev = tail->prev;
 		node->next = tail;
 		tail->prev->next = node;
 		tail->prev = node;
+		if (++since_split == SPLIT_STRIDE) {
+			node->split = true;
+			splits.push_back(node);
+			since_split = 0;
+		}
 	}
 
 	void remove_from_list(Node *node) {
 		node->prev->next = node->next;
 		node->next->prev = node->prev;
+		if (node->split) splits_dirty = true;
+	}
+
+	// links node, which is in no list, just before pos
+	void link_before(Node *node, Node *pos) {
+		node->prev = pos->prev;
+		node->next = pos;
+		pos->prev->next = node;
+		pos->prev = node;
 	}
 
-	void insert_to_table(Node *node) {
-		size_t index = get_bucket_index(node->data->first);
-		Bucket *new_bucket = new Bucket(node);
+	void insert_to_table(Node *node, size_t hash, size_t index) {
+		link_bucket(node, hash, index);
+		if (filter_bits) filter.add(hash);
+	}
+
+	// insert_to_table() without the filter
+	void link_bucket(Node *node, size_t hash, size_t index) {
+		Bucket *new_bucket = &node->bucket;
+		new_bucket->hash = hash;
 		new_bucket->next = table[index];
 		table[index] = new_bucket;
 	}
 
-	void remove_from_table(const Key &key) {
-		size_t index = get_bucket_index(key);
-		Bucket *bucket = table[index];
-		Bucket *prev = nullptr;
+	// constructs a new element from args and appends it; the caller has
+	// made sure its key, whose hash is given, is not in the map yet
+	template<class... Args>
+	Node * append_new(size_t hash, Args &&... args) {
+		if (element_count >= table_size * LOAD_FACTOR) {
+			rehash();
+		}
+		Node *new_node = nodes.create(std::forward<Args>(args)...);
+		insert_to_list(new_node);
+		insert_to_table(new_node, hash, indexer(hash));
+		element_count++;
+		return new_node;
+	}
 
-		while (bucket) {
-			if (equal(bucket->node->data->first, key)) {
-				if (prev) {
-					prev->next = bucket->next;
-				} else {
-					table[index] = bucket->next;
-				}
-				delete bucket;
-				return;
-			}
-			prev = bucket;
-			bucket = bucket->next;
+	// the bodies of compute(), compute_if_absent() and merge(); K is
+	// const Key & or Key, and the key is only moved from on insertion
+	template<class K, class F>
+	T * compute_key(K &&key, F &fn) {
+		size_t hash = hasher(key);
+		Node *node = find_node(key, hash);
+		std::optional<T> result = fn(static_cast<const Key &>(key),
+		                             node ? &node->data->second : static_cast<T *>(nullptr));
+		if (!result) {
+			if (node) erase_node(node);
+			return nullptr;
+		}
+		if (node) {
+			node->data->second = std::move(*result);
+		} else {
+			node = append_new(hash, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+			                  std::forward_as_tuple(std::move(*result)));
+		}
+		return &node->data->second;
+	}
+
+	template<class K, class F>
+	T & compute_if_absent_key(K &&key, F &fn) {
+		size_t hash = hasher(key);
+		Node *node = find_node(key, hash);
+		if (!node) {
+			node = append_new(hash, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+			                  std::forward_as_tuple(fn(static_cast<const Key &>(key))));
+		}
+		return node->data->second;
+	}
+
+	template<class K, class V, class F>
+	T & merge_key(K &&key, V &&value, F &fn) {
+		size_t hash = hasher(key);
+		Node *node = find_node(key, hash);
+		if (node) {
+			fn(node->data->second, std::forward<V>(value));
+		} else {
+			node = append_new(hash, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+			                  std::forward_as_tuple(std::forward<V>(value)));
+		}
+		return node->data->second;
+	}
+
+	// unlinks the bucket of node; no key is hashed or compared
+	void remove_from_table(Node *node) {
+		Bucket **link = table + indexer(node->bucket.hash);
+		while (*link != &node->bucket) link = &(*link)->next;
+		*link = node->bucket.next;
+	}
+
+	void erase_node(Node *node) {
+		remove_from_table(node);
+		remove_from_list(node);
+		nodes.destroy(node);
+		element_count--;
+		// rebuild once erased keys outnumber the live ones
+		if (filter_bits && ++filter_erased > element_count) rebuild_filter();
+	}
+
+	// appends node, whose slab this map owns, unless its key is present;
+	// then it is destroyed. hash is the hash of its key.
+	void adopt_node(Node *node, size_t hash) {
+		if (find_node(node->data->first, hash)) {
+			nodes.destroy(node);
+			return;
+		}
+		if (element_count >= table_size * LOAD_FACTOR) {
+			rehash();
+		}
+		node->split = false;
+		insert_to_list(node);
+		insert_to_table(node, hash, indexer(hash));
+		element_count++;
+	}
+
+	// empties the map after its nodes have been handed to another pool
+	void forget_nodes() {
+		head->next = tail;
+		tail->prev = head;
+		for (size_t i = 0; i < table_size; ++i) {
+			table[i] = nullptr;
+		}
+		element_count = 0;
+		splits.clear();
+		since_split = 0;
+		splits_dirty = false;
+		if (filter_bits) {
+			filter.clear();
+			filter_erased = 0;
 		}
 	}
 
@@ -388,20 +883,56 @@ public:
 	/**
 	 * TODO two constructors
 	 */
-	linked_hashmap() : table(nullptr), table_size(0), element_count(0) {
-		head = new Node();
-		tail = new Node();
-		head->next = tail;
-		tail->prev = head;
+	linked_hashmap() : linked_hashmap(Allocator()) {}
+
+	/**
+	 * an empty map allocating from alloc.
+	 */
+	explicit linked_hashmap(const Allocator &alloc)
+		: table(nullptr), table_size(0), element_count(0), nodes(alloc), rehash_pool(nullptr),
+		  filter(alloc), filter_bits(0), filter_erased(0),
+		  splits(rebind_alloc<Node*>(alloc)), since_split(0), splits_dirty(false) {
+		make_sentinels();
 		init_table(INITIAL_CAPACITY);
 	}
 
-	linked_hashmap(const linked_hashmap &other) : table(nullptr), table_size(0), element_count(0) {
-		head = new Node();
-		tail = new Node();
-		head->next = tail;
-		tail->prev = head;
+	/**
+	 * builds the map from [first, last) using threads threads, with the
+	 *   same contents and order as inserting the elements one by one.
+	 * see bulk_insert().
+	 */
+	template<class RandomIt>
+	linked_hashmap(RandomIt first, RandomIt last, size_t threads, const Allocator &alloc = Allocator())
+		: table(nullptr), table_size(0), element_count(0), nodes(alloc), rehash_pool(nullptr),
+		  filter(alloc), filter_bits(0), filter_erased(0),
+		  splits(rebind_alloc<Node*>(alloc)), since_split(0), splits_dirty(false) {
+		make_sentinels();
+		init_table(INITIAL_CAPACITY);
+
+		thread_pool pool(threads);
+		try {
+			bulk_insert(first, last, &pool);
+		} catch (...) {
+			clear_list();
+			clear_table();
+			free_sentinels();
+			throw;
+		}
+	}
+
+	/**
+	 * copies other's elements in order, along with its miss filter
+	 *   setting; the rehash pool is not copied.
+	 */
+	linked_hashmap(const linked_hashmap &other)
+		: table(nullptr), table_size(0), element_count(0),
+		  nodes(alloc_traits::select_on_container_copy_construction(other.get_allocator())),
+		  rehash_pool(nullptr),
+		  filter(nodes.get_allocator()), filter_bits(0), filter_erased(0),
+		  splits(rebind_alloc<Node*>(nodes.get_allocator())), since_split(0), splits_dirty(false) {
+		make_sentinels();
 		init_table(other.table_size);
+		if (other.filter_bits) enable_miss_filter(other.filter_bits);
 
 		// Copy all elements in insertion order
 		Node *current = other.head->next;
@@ -413,6 +944,8 @@ public:
 
 	/**
 	 * TODO assignment operator
+	 * Like the copy constructor, takes over other's miss filter setting
+	 *   (enabled or not, and its bits per key) rather than keeping its own.
 	 */
 	linked_hashmap & operator=(const linked_hashmap &other) {
 		if (this == &other) return *this;
@@ -420,9 +953,20 @@ public:
 		// Clear current content
 		clear();
 		clear_table();
+		if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+			if (nodes.get_allocator() != other.nodes.get_allocator()) {
+				free_sentinels();
+				nodes.set_allocator(other.nodes.get_allocator());
+				splits = std::vector<Node*, rebind_alloc<Node*> >(rebind_alloc<Node*>(nodes.get_allocator()));
+				filter = detail::blocked_bloom<Allocator>(nodes.get_allocator());
+				make_sentinels();
+			}
+		}
 
-		// Reinitialize with other's size
+		// Reinitialize with other's size and miss filter setting
 		init_table(other.table_size);
+		if (other.filter_bits) enable_miss_filter(other.filter_bits);
+		else disable_miss_filter();
 
 		// Copy all elements
 		Node *current = other.head->next;
@@ -440,8 +984,14 @@ public:
 	~linked_hashmap() {
 		clear_list();
 		clear_table();
-		delete head;
-		delete tail;
+		free_sentinels();
+	}
+
+	/**
+	 * returns the allocator the map allocates from.
+	 */
+	allocator_type get_allocator() const {
+		return nodes.get_allocator();
 	}
 
 	/**
@@ -449,6 +999,8 @@ public:
 	 * access specified element with bounds checking
 	 * Returns a reference to the mapped value of the element with key equivalent to key.
 	 * If no such element exists, an exception of type `index_out_of_bound'
+	 * Throwing is slow; where misses are expected use find_ptr(), get_or()
+	 *   or contains() instead.
 	 */
 	T & at(const Key &key) {
 		Node *node = find_node(key);
@@ -473,12 +1025,23 @@ public:
 	 *   performing an insertion if such key does not already exist.
 	 */
 	T & operator[](const Key &key) {
-		Node *node = find_node(key);
+		size_t hash = hasher(key);
+		Node *node = find_node(key, hash);
 		if (!node) {
 			// Insert with default value
-			value_type new_pair(key, T());
-			auto result = insert(new_pair);
-			return result.first->second;
+			node = append_new(hash, std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>());
+		}
+		return node->data->second;
+	}
+
+	/**
+	 * as above, moving key into the map if it is inserted.
+	 */
+	T & operator[](Key &&key) {
+		size_t hash = hasher(key);
+		Node *node = find_node(key, hash);
+		if (!node) {
+			node = append_new(hash, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::tuple<>());
 		}
 		return node->data->second;
 	}
@@ -494,6 +1057,52 @@ public:
 		return node->data->second;
 	}
 
+	/**
+	 * non-throwing lookups, the recommended way to look up keys that may
+	 *   be missing.
+	 * find_ptr() returns a pointer to the mapped value of key, or nullptr
+	 *   if there is no such element.
+	 */
+	T * find_ptr(const Key &key) {
+		Node *node = find_node(key);
+		return node ? &node->data->second : nullptr;
+	}
+
+	const T * find_ptr(const Key &key) const {
+		Node *node = find_node(key);
+		return node ? &node->data->second : nullptr;
+	}
+
+	/**
+	 * returns a copy of the mapped value of key, or fallback if there is
+	 *   no such element.
+	 */
+	T get_or(const Key &key, const T &fallback) const {
+		Node *node = find_node(key);
+		return node ? node->data->second : fallback;
+	}
+
+	/**
+	 * returns whether there is an element with key.
+	 */
+	bool contains(const Key &key) const {
+		return find_node(key) != nullptr;
+	}
+
+	/**
+	 * the hash of the key at it, as cached in its node when it was
+	 *   inserted: Hash()(it->first) without calling the hash function.
+	 *   Lets a caller partition or re-insert entries by hash for free.
+	 *
+	 * throw invalid_iterator if it is not an element of this map.
+	 */
+	size_t hash_of(const_iterator it) const {
+		if (it.map != this || !it.node || it.node == head || it.node == tail) {
+			throw invalid_iterator();
+		}
+		return it.node->bucket.hash;
+	}
+
 	/**
 	 * return a iterator to the beginning
 	 */
@@ -537,14 +1146,12 @@ public:
 	 */
 	void clear() {
 		clear_list();
-		// Also clear the hash table buckets
+		if (filter_bits) {
+			filter.clear();
+			filter_erased = 0;
+		}
+		// the buckets went with the nodes
 		for (size_t i = 0; i < table_size; ++i) {
-			Bucket *bucket = table[i];
-			while (bucket) {
-				Bucket *next = bucket->next;
-				delete bucket;
-				bucket = next;
-			}
 			table[i] = nullptr;
 		}
 		element_count = 0;
@@ -558,30 +1165,389 @@ public:
 	 */
 	pair<iterator, bool> insert(const value_type &value) {
 		// Check if key already exists
-		Node *existing = find_node(value.first);
+		size_t hash = hasher(value.first);
+		Node *existing = find_node(value.first, hash);
 		if (existing) {
 			return pair<iterator, bool>(iterator(existing, this), false);
 		}
+		return pair<iterator, bool>(iterator(append_new(hash, value), this), true);
+	}
 
-		// Check if rehash is needed
-		if (element_count >= table_size * LOAD_FACTOR) {
-			rehash();
+	/**
+	 * as above, moving the mapped value of value into the map; the key is
+	 *   copied since value_type::first is const. emplace() moves both.
+	 */
+	pair<iterator, bool> insert(value_type &&value) {
+		size_t hash = hasher(value.first);
+		Node *existing = find_node(value.first, hash);
+		if (existing) {
+			return pair<iterator, bool>(iterator(existing, this), false);
 		}
+		return pair<iterator, bool>(iterator(append_new(hash, std::move(value)), this), true);
+	}
 
-		// Create new node
-		Node *new_node = new Node(value);
+	/**
+	 * inserts key with a value constructed from args unless key is
+	 *   already present, in which case nothing is constructed and args
+	 *   are left alone. The key is hashed once either way, so
+	 *
+	 *     pair<iterator, bool> r = map.try_emplace(key, init);
+	 *     if (!r.second) update(r.first->second);
+	 *
+	 *   is an upsert with a single probe.
+	 * return as insert().
+	 */
+	template<class... Args>
+	pair<iterator, bool> try_emplace(const Key &key, Args &&... args) {
+		size_t hash = hasher(key);
+		Node *existing = find_node(key, hash);
+		if (existing) {
+			return pair<iterator, bool>(iterator(existing, this), false);
+		}
+		Node *node = append_new(hash, std::piecewise_construct, std::forward_as_tuple(key),
+		                        std::forward_as_tuple(std::forward<Args>(args)...));
+		return pair<iterator, bool>(iterator(node, this), true);
+	}
 
-		// Insert into linked list
-		insert_to_list(new_node);
+	template<class... Args>
+	pair<iterator, bool> try_emplace(Key &&key, Args &&... args) {
+		size_t hash = hasher(key);
+		Node *existing = find_node(key, hash);
+		if (existing) {
+			return pair<iterator, bool>(iterator(existing, this), false);
+		}
+		Node *node = append_new(hash, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+		                        std::forward_as_tuple(std::forward<Args>(args)...));
+		return pair<iterator, bool>(iterator(node, this), true);
+	}
 
-		// Insert into hash table
-		insert_to_table(new_node);
+	/**
+	 * read-modify-write of one key with a single probe, after Java's Map;
+	 *   fn must not modify the map. Each has an overload taking the key
+	 *   by rvalue reference, which moves it into the map if inserted.
+	 *
+	 * compute(key, fn): fn(key, current) gets a pointer to the value of
+	 *   key, or nullptr if absent, and returns a std::optional<T>: a value
+	 *   replaces or inserts, std::nullopt erases or inserts nothing.
+	 *   Returns a pointer to the value now mapped, or nullptr.
+	 */
+	template<class F>
+	T * compute(const Key &key, F fn) {
+		return compute_key(key, fn);
+	}
 
-		element_count++;
+	template<class F>
+	T * compute(Key &&key, F fn) {
+		return compute_key(std::move(key), fn);
+	}
+
+	/**
+	 * compute_if_present(key, fn): if key is present, fn(key, value)
+	 *   updates value in place and returns whether to keep it; false
+	 *   erases the element. Returns a pointer to the value, or nullptr if
+	 *   key was absent or has been erased.
+	 */
+	template<class F>
+	T * compute_if_present(const Key &key, F fn) {
+		Node *node = find_node(key);
+		if (!node) return nullptr;
+		if (!fn(key, node->data->second)) {
+			erase_node(node);
+			return nullptr;
+		}
+		return &node->data->second;
+	}
+
+	/**
+	 * compute_if_absent(key, fn): if key is absent, inserts it with a
+	 *   value constructed from the result of fn(key); fn is not called
+	 *   otherwise. Returns the value of key. The result is a temporary
+	 *   first, so a T returned by fn is moved into the map; for a T that
+	 *   cannot be moved, use try_emplace() with its constructor arguments.
+	 */
+	template<class F>
+	T & compute_if_absent(const Key &key, F fn) {
+		return compute_if_absent_key(key, fn);
+	}
 
+	template<class F>
+	T & compute_if_absent(Key &&key, F fn) {
+		return compute_if_absent_key(std::move(key), fn);
+	}
+
+	/**
+	 * merge(key, value, fn): inserts key with value if absent, otherwise
+	 *   combines value into the present one in place with
+	 *   fn(current, value). Returns the value of key. A counter is
+	 *
+	 *     map.merge(word, 1, [](int &count, int one) { count += one; });
+	 */
+	template<class V, class F>
+	T & merge(const Key &key, V &&value, F fn) {
+		return merge_key(key, std::forward<V>(value), fn);
+	}
+
+	template<class V, class F>
+	T & merge(Key &&key, V &&value, F fn) {
+		return merge_key(std::move(key), std::forward<V>(value), fn);
+	}
+
+	/**
+	 * constructs an element in place from args (as value_type(args...))
+	 *   and inserts it unless its key is already in the map, in which case
+	 *   the new element is destroyed again.
+	 * return the same as insert().
+	 */
+	template<class... Args>
+	pair<iterator, bool> emplace(Args &&... args) {
+		Node *new_node = nodes.create(std::forward<Args>(args)...);
+		size_t hash = hasher(new_node->data->first);
+		Node *existing = find_node(new_node->data->first, hash);
+		if (existing) {
+			nodes.destroy(new_node);
+			return pair<iterator, bool>(iterator(existing, this), false);
+		}
+		if (element_count >= table_size * LOAD_FACTOR) {
+			try {
+				rehash();
+			} catch (...) {
+				nodes.destroy(new_node);
+				throw;
+			}
+		}
+		insert_to_list(new_node);
+		insert_to_table(new_node, hash, indexer(hash));
+		element_count++;
 		return pair<iterator, bool>(iterator(new_node, this), true);
 	}
 
+	/**
+	 * makes room for n elements, so that inserting up to n elements in
+	 *   total does not rehash.
+	 */
+	void reserve(size_t n) {
+		size_t buckets = IndexPolicy::round_up((size_t)(n / LOAD_FACTOR) + 1);
+		if (buckets > table_size) {
+			rehash_to(buckets);
+		}
+	}
+
+	/**
+	 * rebuilds the table with at least count buckets, and at least
+	 *   enough for the current elements.
+	 */
+	void rehash(size_t count) {
+		size_t needed = (size_t)(element_count / LOAD_FACTOR) + 1;
+		rehash_to(IndexPolicy::round_up(count > needed ? count : needed));
+	}
+
+	/**
+	 * runs rehashes of maps with many elements on pool,
+	 *   or on the calling thread only if pool is nullptr (the default).
+	 * The pool is not owned and must outlive its use by the map. Copies
+	 *   of the map start without a pool. Several maps may share one pool;
+	 *   their parallel rehashes then take turns.
+	 */
+	void set_rehash_pool(thread_pool *pool) {
+		rehash_pool = pool;
+	}
+
+	/**
+	 * returns the number of buckets.
+	 */
+	size_t bucket_count() const {
+		return table_size;
+	}
+
+	/**
+	 * puts a Bloom filter of bits_per_key bits per key of capacity in
+	 *   front of the table (see miss_filter.hpp), so that lookups of
+	 *   missing keys (count(), find(), at(), contains(), ... and the
+	 *   duplicate check of insert()) usually return after touching one
+	 *   block of it, without walking a chain. Costs bits_per_key / 8
+	 *   bytes per key and a hash per insert; the filter is rebuilt on
+	 *   rehash and once erased keys outnumber the live ones.
+	 * Worth it when nearly all lookups miss: a hit pays for the filter
+	 *   on top of the chain walk, and on maps far beyond the cache the
+	 *   hit-or-miss branch costs more than the filter saves unless misses
+	 *   are the rule. The batched and interleaved lookups do not consult it.
+	 */
+	void enable_miss_filter(size_t bits_per_key = 12) {
+		filter_bits = bits_per_key ? bits_per_key : 1;
+		rebuild_filter();
+	}
+
+	void disable_miss_filter() {
+		filter_bits = 0;
+		filter_erased = 0;
+		filter.release();
+	}
+
+	struct miss_filter_stats {
+		bool enabled;
+		size_t bits;  // size of the filter
+		size_t keys;  // keys in it, erased ones included
+		size_t erased;  // of those, erased from the map since the last rebuild
+		double false_positive_rate;  // expected, for a key not in the filter
+	};
+
+	/**
+	 * returns the state of the miss filter; all zero while disabled.
+	 */
+	miss_filter_stats filter_stats() const {
+		miss_filter_stats stats = {false, 0, 0, 0, 0.0};
+		if (filter_bits) {
+			stats.enabled = true;
+			stats.bits = filter.bit_count();
+			stats.keys = filter.key_count();
+			stats.erased = filter_erased;
+			stats.false_positive_rate = filter.false_positive_rate();
+		}
+		return stats;
+	}
+
+	/**
+	 * inserts the elements of [first, last) (pairs with .first and .second)
+	 *   in parallel on pool, with exactly the effect of calling insert()
+	 *   on each of them in order: the first occurrence of a key wins and
+	 *   new keys are appended in the order of their first occurrence.
+	 * Falls back to sequential inserts if pool is nullptr, and for any
+	 *   Allocator but std::allocator, which might not be thread-safe.
+	 * return the number of elements actually inserted.
+	 */
+	template<class RandomIt>
+	size_t bulk_insert(RandomIt first, RandomIt last, thread_pool *pool = nullptr) {
+		static_assert(std::is_base_of<std::random_access_iterator_tag,
+			typename std::iterator_traits<RandomIt>::iterator_category>::value,
+			"bulk_insert needs random access iterators");
+		size_t n = last - first;
+		if (!CONCURRENT_ALLOCATOR || !pool || pool->size() == 1 || n < PARALLEL_MIN) {
+			size_t inserted = 0;
+			for (; first != last; ++first) {
+				inserted += insert(value_type(first->first, first->second)).second;
+			}
+			return inserted;
+		}
+		reserve(element_count + n);
+
+		// 1. hash every row and sort it by the range of the table its
+		//    bucket lies in, keeping input order within each list
+		size_t parts = pool->size();
+		std::vector<size_t> hash(n), index(n);
+		std::vector<std::vector<size_t> > rows(parts * parts);
+		pool->run(parts, [&](size_t t) {
+			std::vector<std::vector<size_t> > lists(parts);
+			for (size_t i = n * t / parts; i < n * (t + 1) / parts; ++i) {
+				hash[i] = hasher(first[i].first);
+				index[i] = indexer(hash[i]);
+				lists[index[i] * parts / table_size].push_back(i);
+			}
+			for (size_t d = 0; d < parts; ++d) rows[t * parts + d].swap(lists[d]);
+		});
+
+		// 2. each range of the table is owned by one thread, which inserts
+		//    the first occurrence of every new key into its buckets
+		std::vector<Node*> created(n, nullptr);
+		std::vector<NodePool> local;
+		local.reserve(parts);
+		for (size_t d = 0; d < parts; ++d) local.emplace_back(nodes.get_allocator());
+		std::exception_ptr error;
+		try {
+			pool->run(parts, [&](size_t d) {
+				for (size_t t = 0; t < parts; ++t) {
+					const std::vector<size_t> &list = rows[t * parts + d];
+					for (size_t k = 0; k < list.size(); ++k) {
+						size_t i = list[k];
+						if (find_node(first[i].first, hash[i], index[i])) continue;
+						Node *node = local[d].create(first[i].first, first[i].second);
+						link_bucket(node, hash[i], index[i]);
+						created[i] = node;
+					}
+				}
+			});
+		} catch (...) {
+			// keep the map consistent: link whatever made it into the table
+			error = std::current_exception();
+		}
+		for (size_t d = 0; d < parts; ++d) nodes.splice(local[d]);
+
+		// 3. chain the new nodes in input order, a slice per thread,
+		//    then append the slices to the order list
+		std::vector<Node*> chain_head(parts, nullptr), chain_tail(parts, nullptr);
+		std::vector<size_t> chain_size(parts, 0);
+		pool->run(parts, [&](size_t t) {
+			Node *last_node = nullptr;
+			for (size_t i = n * t / parts; i < n * (t + 1) / parts; ++i) {
+				Node *node = created[i];
+				if (!node) continue;
+				if (last_node) {
+					last_node->next = node;
+					node->prev = last_node;
+				} else {
+					chain_head[t] = node;
+				}
+				last_node = node;
+				chain_size[t]++;
+			}
+			chain_tail[t] = last_node;
+		});
+		size_t inserted = 0;
+		for (size_t t = 0; t < parts; ++t) {
+			if (!chain_head[t]) continue;
+			chain_head[t]->prev = tail->prev;
+			tail->prev->next = chain_head[t];
+			chain_tail[t]->next = tail;
+			tail->prev = chain_tail[t];
+			inserted += chain_size[t];
+		}
+		element_count += inserted;
+		if (inserted) splits_dirty = true;
+		// the threads above left the filter alone
+		if (filter_bits) rebuild_filter();
+
+		if (error) std::rethrow_exception(error);
+		return inserted;
+	}
+
+	/**
+	 * batched insert, equivalent to calling insert(values[i]) for i = 0 .. n-1.
+	 * Bucket indices are computed and prefetched a batch at a time
+	 *   (vectorized for 32/64-bit integer keys hashed by std::hash).
+	 * return the number of elements actually inserted.
+	 */
+	size_t insert_batch(const value_type *values, size_t n) {
+		size_t inserted = 0;
+		size_t hash[BATCH_SIZE], index[BATCH_SIZE];
+		for (size_t first = 0; first < n; first += BATCH_SIZE) {
+			size_t m = n - first < BATCH_SIZE ? n - first : BATCH_SIZE;
+			const value_type *batch = values + first;
+
+			// grow once for the whole batch so the indices stay valid
+			reserve(element_count + m);
+			if constexpr (detail::batch_hashable<Key, Hash>::value) {
+				Key keys[BATCH_SIZE];
+				for (size_t i = 0; i < m; ++i) keys[i] = batch[i].first;
+				get_bucket_indices(keys, m, hash, index);
+			} else {
+				for (size_t i = 0; i < m; ++i) {
+					hash[i] = hasher(batch[i].first);
+					index[i] = indexer(hash[i]);
+				}
+			}
+			for (size_t i = 0; i < m; ++i) prefetch_bucket(index[i]);
+
+			for (size_t i = 0; i < m; ++i) {
+				if (find_node(batch[i].first, hash[i], index[i])) continue;
+				Node *new_node = nodes.create(batch[i]);
+				insert_to_list(new_node);
+				insert_to_table(new_node, hash[i], index[i]);
+				element_count++;
+				inserted++;
+			}
+		}
+		return inserted;
+	}
+
 	/**
 	 * erase the element at pos.
 	 *
@@ -592,16 +1558,183 @@ public:
 			throw invalid_iterator();
 		}
 
-		// Remove from hash table
-		remove_from_table(pos.node->data->first);
+		erase_node(pos.node);
+	}
 
-		// Remove from linked list
-		remove_from_list(pos.node);
+	/**
+	 * moves the element at it to just before pos in the iteration order,
+	 *   in O(1); iterators stay valid. pos may be end(); it == pos does
+	 *   nothing. This is what lets an LRU or LFU order live in the map's
+	 *   own list, see cache.hpp.
+	 *
+	 * throw invalid_iterator if it is not an element of this map or pos
+	 *   is not an iterator of this map.
+	 */
+	void move_before(iterator it, iterator pos) {
+		if (it.map != this || !it.node || it.node == head || it.node == tail) {
+			throw invalid_iterator();
+		}
+		if (pos.map != this || !pos.node || pos.node == head) {
+			throw invalid_iterator();
+		}
+		if (it.node == pos.node || it.node->next == pos.node) return;
+		remove_from_list(it.node);
+		link_before(it.node, pos.node);
+	}
 
-		// Delete node
-		delete pos.node;
+	/**
+	 * moves the element at it to the end / the beginning of the
+	 *   iteration order, as if it had been inserted last / first.
+	 */
+	void move_to_back(iterator it) {
+		move_before(it, end());
+	}
 
-		element_count--;
+	void move_to_front(iterator it) {
+		move_before(it, begin());
+	}
+
+	/**
+	 * the eldest / the newest element in the iteration order, in O(1).
+	 * With the insertion order (or move_to_back()) the map is then a
+	 *   queue without duplicate keys.
+	 *
+	 * throw container_is_empty if the map is empty.
+	 */
+	value_type & front() {
+		if (element_count == 0) throw container_is_empty();
+		return *head->next->data;
+	}
+
+	const value_type & front() const {
+		if (element_count == 0) throw container_is_empty();
+		return *head->next->data;
+	}
+
+	value_type & back() {
+		if (element_count == 0) throw container_is_empty();
+		return *tail->prev->data;
+	}
+
+	const value_type & back() const {
+		if (element_count == 0) throw container_is_empty();
+		return *tail->prev->data;
+	}
+
+	/**
+	 * erases the eldest / the newest element. Like erase(), it finds the
+	 *   bucket from the cached hash, without hashing the key.
+	 *
+	 * throw container_is_empty if the map is empty.
+	 */
+	void pop_front() {
+		if (element_count == 0) throw container_is_empty();
+		erase_node(head->next);
+	}
+
+	void pop_back() {
+		if (element_count == 0) throw container_is_empty();
+		erase_node(tail->prev);
+	}
+
+	/**
+	 * erases the k eldest elements, or all of them if k >= size(), and
+	 *   returns how many were erased. The k nodes leave the list in one
+	 *   splice; when they are most of the map the survivors are relinked
+	 *   into emptied slots instead of the k buckets being unlinked one
+	 *   chain at a time. No key is hashed.
+	 */
+	size_t trim_front(size_t k) {
+		if (k >= element_count) {
+			k = element_count;
+			clear();
+			return k;
+		}
+		if (k == 0) return 0;
+		Node *first = head->next, *last = first;
+		for (size_t i = 1; i < k; ++i) last = last->next;
+		head->next = last->next;
+		last->next->prev = head;
+
+		bool relink = k > element_count / 2;
+		if (relink) {
+			for (size_t i = 0; i < table_size; ++i) table[i] = nullptr;
+		}
+		Node *stop = last->next;
+		for (Node *node = first; node != stop; ) {
+			Node *next = node->next;
+			if (node->split) splits_dirty = true;
+			if (!relink) remove_from_table(node);
+			nodes.destroy(node);
+			node = next;
+		}
+		element_count -= k;
+		if (relink) {
+			for (Node *node = head->next; node != tail; node = node->next) {
+				link_bucket(node, node->bucket.hash, indexer(node->bucket.hash));
+			}
+		}
+		if (filter_bits && (filter_erased += k) > element_count) rebuild_filter();
+		return k;
+	}
+
+	/**
+	 * k-way merge of sources[0 .. k - 1] onto the end of this map in
+	 *   ascending stamp order, first wins: stamps[i][j] is the stamp of
+	 *   the j-th element of sources[i] in iteration order, ascending
+	 *   within each source. An element whose key is already in this map,
+	 *   or came with a smaller stamp, is destroyed. The sources, distinct
+	 *   maps other than this one, are left empty; throw runtime_error if
+	 *   this map is among them.
+	 * The nodes themselves change maps, so no key or value is copied or
+	 *   moved; with a stateless Hash no key is hashed either. If a
+	 *   source's allocator differs from this one, its values are moved
+	 *   into new nodes instead.
+	 * Building one map per thread and merging them this way gives the
+	 *   map that inserting every element in stamp order would have built,
+	 *   see stamped_shards.hpp.
+	 */
+	void merge_stamped(linked_hashmap *const *sources, const std::uint64_t *const *stamps, size_t k) {
+		typedef std::pair<std::uint64_t, size_t> entry;  // stamp, source
+		std::vector<Node*> cursor(k);
+		std::vector<size_t> position(k, 0);
+		std::vector<bool> relink(k);
+		std::vector<entry> heap;
+		size_t largest = 0;
+		for (size_t i = 0; i < k; ++i) {
+			if (sources[i] == this) throw runtime_error();
+			if (sources[i]->element_count > largest) largest = sources[i]->element_count;
+		}
+		// at least this many; duplicates across sources make the sum an
+		// overestimate
+		reserve(element_count + largest);
+		for (size_t i = 0; i < k; ++i) {
+			relink[i] = sources[i]->nodes.get_allocator() == nodes.get_allocator();
+			if (relink[i]) nodes.splice(sources[i]->nodes);
+			cursor[i] = sources[i]->head->next;
+			if (cursor[i] != sources[i]->tail) heap.push_back(entry(stamps[i][0], i));
+		}
+		std::make_heap(heap.begin(), heap.end(), std::greater<entry>());
+		while (!heap.empty()) {
+			std::pop_heap(heap.begin(), heap.end(), std::greater<entry>());
+			size_t i = heap.back().second;
+			heap.pop_back();
+			Node *node = cursor[i];
+			cursor[i] = node->next;
+			if (cursor[i] != sources[i]->tail) {
+				heap.push_back(entry(stamps[i][++position[i]], i));
+				std::push_heap(heap.begin(), heap.end(), std::greater<entry>());
+			}
+			if (relink[i]) {
+				adopt_node(node, std::is_empty<Hash>::value ? node->bucket.hash : hasher(node->data->first));
+			} else {
+				try_emplace(node->data->first, std::move(node->data->second));
+			}
+		}
+		for (size_t i = 0; i < k; ++i) {
+			if (relink[i]) sources[i]->forget_nodes();
+			else sources[i]->clear();
+		}
 	}
 
 	/**
@@ -635,8 +1768,178 @@ public:
 		}
 		return cend();
 	}
+
+	/**
+	 * batched lookup of keys[0 .. n-1].
+	 * results[i] points to the element with key keys[i], or is nullptr
+	 *   if there is no such element.
+	 */
+	void find_batch(const Key *keys, size_t n, value_type **results) {
+		const linked_hashmap *self = this;
+		self->find_batch(keys, n, const_cast<const value_type **>(results));
+	}
+
+	void find_batch(const Key *keys, size_t n, const value_type **results) const {
+		size_t hash[BATCH_SIZE], index[BATCH_SIZE];
+		for (size_t first = 0; first < n; first += BATCH_SIZE) {
+			size_t m = n - first < BATCH_SIZE ? n - first : BATCH_SIZE;
+			get_bucket_indices(keys + first, m, hash, index);
+			for (size_t i = 0; i < m; ++i) prefetch_bucket(index[i]);
+			for (size_t i = 0; i < m; ++i) {
+				Node *node = find_node(keys[first + i], hash[i], index[i]);
+				results[first + i] = node ? node->data : nullptr;
+			}
+		}
+	}
+
+	/**
+	 * calls fn(value) for every element, in parallel on pool.
+	 * fn may modify the mapped values but not the map itself.
+	 */
+	template<class F>
+	void parallel_for_each(F fn, thread_pool &pool) {
+		for_each_segment(pool, [&](size_t, Node *first, Node *last) {
+			for (Node *node = first; node != last; node = node->next) fn(*node->data);
+		});
+	}
+
+	/**
+	 * returns reduce(...reduce(reduce(init, transform(e1)), transform(e2))...)
+	 *   over the elements in insertion order, evaluated in parallel on pool.
+	 * reduce must be associative; it need not be commutative.
+	 */
+	template<class R, class Transform, class Reduce>
+	R parallel_reduce(R init, Transform transform, Reduce reduce, thread_pool &pool) const {
+		std::vector<std::optional<R> > partial(segment_count());
+		for_each_segment(pool, [&](size_t i, Node *first, Node *last) {
+			if (first == last) return;
+			R acc = transform(static_cast<const value_type &>(*first->data));
+			for (Node *node = first->next; node != last; node = node->next) {
+				acc = reduce(acc, transform(static_cast<const value_type &>(*node->data)));
+			}
+			partial[i] = acc;
+		});
+		for (size_t i = 0; i < partial.size(); ++i) {
+			if (partial[i]) init = reduce(init, *partial[i]);
+		}
+		return init;
+	}
+
+	/**
+	 * inserts every element satisfying pred into out (e.g. another
+	 *   linked_hashmap), in insertion order; pred runs in parallel on pool.
+	 */
+	template<class Out, class Pred>
+	void parallel_filter_into(Out &out, Pred pred, thread_pool &pool) const {
+		std::vector<std::vector<const value_type *> > matches(segment_count());
+		for_each_segment(pool, [&](size_t i, Node *first, Node *last) {
+			for (Node *node = first; node != last; node = node->next) {
+				if (pred(static_cast<const value_type &>(*node->data))) matches[i].push_back(node->data);
+			}
+		});
+		for (size_t i = 0; i < matches.size(); ++i) {
+			for (size_t k = 0; k < matches[i].size(); ++k) out.insert(*matches[i][k]);
+		}
+	}
+
+	/**
+	 * aggregates over all mapped values, for arithmetic T only.
+	 * They scan the value arrays of the entry slabs instead of following
+	 *   the list, in branch-free loops the compiler can vectorize.
+	 * The arrays hold whole value_type entries, so the mapped values are
+	 *   strided by sizeof(value_type), not a packed column of T: a
+	 *   separate column would have to be kept in sync with every T&
+	 *   handed out by operator[], at() and the iterators.
+	 * sum_values() accumulates in R, T by default.
+	 */
+	template<class R = T>
+	R sum_values() const {
+		static_assert(std::is_arithmetic<T>::value, "sum_values needs an arithmetic mapped type");
+		R sum = R();
+		nodes.for_each_slab([&](const value_type *values, const unsigned char *live, size_t n) {
+			R acc = R();
+			for (size_t i = 0; i < n; ++i) {
+				acc += live[i] ? (R)values[i].second : R();
+			}
+			sum += acc;
+		});
+		return sum;
+	}
+
+	/**
+	 * smallest mapped value; throw container_is_empty if the map is empty.
+	 */
+	T min_value() const {
+		static_assert(std::is_arithmetic<T>::value, "min_value needs an arithmetic mapped type");
+		if (element_count == 0) throw container_is_empty();
+		T result = std::numeric_limits<T>::max();
+		nodes.for_each_slab([&](const value_type *values, const unsigned char *live, size_t n) {
+			T acc = result;
+			for (size_t i = 0; i < n; ++i) {
+				T v = live[i] ? values[i].second : acc;
+				acc = v < acc ? v : acc;
+			}
+			result = acc;
+		});
+		return result;
+	}
+
+	/**
+	 * largest mapped value; throw container_is_empty if the map is empty.
+	 */
+	T max_value() const {
+		static_assert(std::is_arithmetic<T>::value, "max_value needs an arithmetic mapped type");
+		if (element_count == 0) throw container_is_empty();
+		T result = std::numeric_limits<T>::lowest();
+		nodes.for_each_slab([&](const value_type *values, const unsigned char *live, size_t n) {
+			T acc = result;
+			for (size_t i = 0; i < n; ++i) {
+				T v = live[i] ? values[i].second : acc;
+				acc = v > acc ? v : acc;
+			}
+			result = acc;
+		});
+		return result;
+	}
+
+	/**
+	 * number of mapped values v with pred(v); pred is called once per
+	 *   element and never on an erased or unused slot.
+	 */
+	template<class Pred>
+	size_t count_values_if(Pred pred) const {
+		static_assert(std::is_arithmetic<T>::value, "count_values_if needs an arithmetic mapped type");
+		size_t count = 0;
+		nodes.for_each_slab([&](const value_type *values, const unsigned char *live, size_t n) {
+			size_t acc = 0;
+			for (size_t i = 0; i < n; ++i) {
+				// pred must only ever see live values
+				if (live[i]) acc += pred(values[i].second) ? 1 : 0;
+			}
+			count += acc;
+		});
+		return count;
+	}
 };
 
+namespace pmr {
+
+/**
+ * linked_hashmap allocating from a std::pmr::memory_resource, e.g.
+ *   std::pmr::monotonic_buffer_resource arena;
+ *   sjtu::pmr::linked_hashmap<int, int> map(&arena);
+ */
+template<
+	class Key,
+	class T,
+	class Hash = std::hash<Key>,
+	class Equal = std::equal_to<Key>,
+	class IndexPolicy = prime_index
+> using linked_hashmap = sjtu::linked_hashmap<Key, T, Hash, Equal, IndexPolicy,
+	std::pmr::polymorphic_allocator<pair<const Key, T> > >;
+
+}
+
 }
 
 #endif
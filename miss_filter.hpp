@@ -0,0 +1,136 @@
+/**
+ * approximate-membership filter for linked_hashmap's negative lookups.
+ *
+ * A split block Bloom filter: the filter is an array of 32-byte blocks
+ * of eight 32-bit words; a key picks one block and sets one bit in each
+ * of its words. A lookup therefore touches a single block (half a cache
+ * line) and the eight probes vectorize. Keys cannot be removed; the map
+ * rebuilds the filter instead, see linked_hashmap::enable_miss_filter().
+ */
+#ifndef SJTU_MISS_FILTER_HPP
+#define SJTU_MISS_FILTER_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sjtu {
+namespace detail {
+
+template<class Allocator>
+class blocked_bloom {
+public:
+	static const size_t BLOCK_BITS = 256;
+
+private:
+	struct alignas(32) Block {
+		std::uint32_t word[8];
+	};
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Block> block_allocator;
+
+	std::vector<Block, block_allocator> blocks;
+	size_t keys;
+
+	// hashes of integers may be the identity; spread every bit first
+	static std::uint64_t mix(size_t hash) {
+		std::uint64_t x = hash;
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdull;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ull;
+		x ^= x >> 33;
+		return x;
+	}
+
+	size_t block_index(std::uint64_t x) const {
+#ifdef __SIZEOF_INT128__
+		return (size_t)(((unsigned __int128)x * blocks.size()) >> 64);
+#else
+		return (size_t)(x % blocks.size());
+#endif
+	}
+
+	// the bit of word i for a key
+	static std::uint32_t bit(std::uint64_t x, int i) {
+		static const std::uint32_t salt[8] = {
+			0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+			0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+		};
+		return (std::uint32_t)1 << (((std::uint32_t)x * salt[i]) >> 27);
+	}
+
+public:
+	explicit blocked_bloom(const Allocator &alloc = Allocator())
+		: blocks(block_allocator(alloc)), keys(0) {}
+
+	/**
+	 * empties the filter and sizes it for capacity keys at bits_per_key.
+	 */
+	void reset(size_t capacity, size_t bits_per_key) {
+		size_t count = (capacity * bits_per_key + BLOCK_BITS - 1) / BLOCK_BITS;
+		blocks.assign(count ? count : 1, Block());
+		keys = 0;
+	}
+
+	void clear() {
+		blocks.assign(blocks.size(), Block());
+		keys = 0;
+	}
+
+	void release() {
+		std::vector<Block, block_allocator>(blocks.get_allocator()).swap(blocks);
+		keys = 0;
+	}
+
+	void add(size_t hash) {
+		std::uint64_t x = mix(hash);
+		Block &block = blocks[block_index(x)];
+		for (int i = 0; i < 8; ++i) block.word[i] |= bit(x, i);
+		++keys;
+	}
+
+	/**
+	 * false if no key with this hash was added; true if one probably was.
+	 */
+	bool may_contain(size_t hash) const {
+		std::uint64_t x = mix(hash);
+		const Block &block = blocks[block_index(x)];
+		std::uint32_t missing = 0;
+		for (int i = 0; i < 8; ++i) missing |= ~block.word[i] & bit(x, i);
+		return missing == 0;
+	}
+
+	size_t bit_count() const {
+		return blocks.size() * BLOCK_BITS;
+	}
+
+	// keys added since the last reset, removed ones included
+	size_t key_count() const {
+		return keys;
+	}
+
+	/**
+	 * the expected false-positive rate for the keys added so far: a block
+	 *   holding j keys lets a probe through with (1 - (31/32)^j)^8, and
+	 *   the block loads are Poisson distributed.
+	 */
+	double false_positive_rate() const {
+		if (blocks.empty() || keys == 0) return 0;
+		double load = (double)keys / blocks.size();
+		double p = std::exp(-load);  // Poisson(j; load)
+		double rate = 0;
+		size_t last = (size_t)(load + 12 * std::sqrt(load) + 24);
+		for (size_t j = 1; j <= last; ++j) {
+			p *= load / j;
+			rate += p * std::pow(1 - std::pow(31.0 / 32, (double)j), 8);
+		}
+		return rate;
+	}
+};
+
+}
+}
+
+#endif
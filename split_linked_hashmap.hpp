@@ -0,0 +1,566 @@
+/**
+ * a linked_hashmap with a split (structure-of-arrays) entry layout.
+ *
+ * Keys live in one contiguous array together with their cached hash and
+ * bucket-chain link; mapped values live in a parallel array indexed by
+ * the same slot, and the insertion-order links in a third one. A lookup
+ * walks only bucket heads and key slots, and loads a value only once the
+ * key has matched, so maps with small keys and large values keep their
+ * probing working set small.
+ *
+ * Differences from linked_hashmap:
+ *   - dereferencing an iterator gives a proxy pair<const Key&, T&>;
+ *   - iterators are slot indices and survive growth, but references and
+ *     pointers to keys and values are invalidated when an insertion grows
+ *     the slot arrays.
+ */
+#ifndef SJTU_SPLIT_LINKED_HASHMAP_HPP
+#define SJTU_SPLIT_LINKED_HASHMAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "index_policy.hpp"
+
+namespace sjtu {
+
+template<
+	class Key,
+	class T,
+	class Hash = std::hash<Key>,
+	class Equal = std::equal_to<Key>,
+	class IndexPolicy = prime_index
+> class split_linked_hashmap {
+public:
+	typedef pair<const Key, T> value_type;
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef pair<const Key &, T &> reference;
+	typedef pair<const Key &, const T &> const_reference;
+
+private:
+	static const size_t NIL = ~(size_t)0;
+
+	// the probed part of a slot
+	struct KeySlot {
+		size_t hash;
+		size_t chain;  // next slot in the bucket, or in the free list
+		Key key;
+	};
+
+	// the insertion-order links of a slot; free slots have prev == DEAD
+	struct Link {
+		size_t prev;
+		size_t next;
+	};
+	static const size_t DEAD = NIL - 1;
+
+	KeySlot *key_slots;
+	T *values;
+	Link *links;
+	size_t capacity;     // slots allocated
+	size_t used;         // slots ever handed out, live or free
+	size_t free_slots;   // head of the free list
+	size_t element_count;
+
+	size_t *buckets;
+	size_t bucket_size;
+
+	size_t first;
+	size_t last;
+
+	Hash hasher;
+	Equal equal;
+	IndexPolicy indexer;
+
+	static const size_t INITIAL_CAPACITY = 16;
+	static constexpr double LOAD_FACTOR = 1.0;
+
+	template<class U>
+	static U * allocate(size_t n) {
+		return static_cast<U *>(::operator new(n * sizeof(U), std::align_val_t(alignof(U))));
+	}
+
+	template<class U>
+	static void deallocate(U *p) {
+		::operator delete(p, std::align_val_t(alignof(U)));
+	}
+
+	bool live(size_t slot) const {
+		return links[slot].prev != DEAD;
+	}
+
+	void init_buckets(size_t n) {
+		bucket_size = IndexPolicy::round_up(n);
+		indexer.reset(bucket_size);
+		buckets = new size_t[bucket_size];
+		for (size_t i = 0; i < bucket_size; ++i) buckets[i] = NIL;
+	}
+
+	// rebuilds the bucket chains from the cached hashes
+	void rehash_to(size_t n) {
+		delete[] buckets;
+		init_buckets(n);
+		for (size_t slot = first; slot != NIL; slot = links[slot].next) {
+			size_t index = indexer(key_slots[slot].hash);
+			key_slots[slot].chain = buckets[index];
+			buckets[index] = slot;
+		}
+	}
+
+	// constructs key, and the value from args, in the free slot of keys
+	// and vals
+	template<class K, class... Args>
+	static void construct_slot(KeySlot *keys, T *vals, size_t slot, K &&key, Args &&... args) {
+		new (&keys[slot].key) Key(std::forward<K>(key));
+		try {
+			new (vals + slot) T(std::forward<Args>(args)...);
+		} catch (...) {
+			keys[slot].key.~Key();
+			throw;
+		}
+	}
+
+	// moves all slots into arrays of n slots, keeping slot numbers, and
+	// constructs the new element in slot used of them first: like
+	// std::vector::emplace_back, this lets key and args refer to elements
+	// of the old arrays, which are only freed at the end
+	template<class K, class... Args>
+	void grow_slots(size_t n, K &&key, Args &&... args) {
+		KeySlot *new_keys = allocate<KeySlot>(n);
+		T *new_values = nullptr;
+		Link *new_links = nullptr;
+		bool built = false;
+		size_t moved = 0;
+		try {
+			new_values = allocate<T>(n);
+			new_links = allocate<Link>(n);
+			construct_slot(new_keys, new_values, used, std::forward<K>(key), std::forward<Args>(args)...);
+			built = true;
+			for (; moved < used; ++moved) {
+				new_links[moved] = links[moved];
+				if (!live(moved)) {
+					new_keys[moved].chain = key_slots[moved].chain;
+					continue;
+				}
+				new (&new_keys[moved].key) Key(std::move_if_noexcept(key_slots[moved].key));
+				try {
+					new (new_values + moved) T(std::move_if_noexcept(values[moved]));
+				} catch (...) {
+					new_keys[moved].key.~Key();
+					throw;
+				}
+				new_keys[moved].hash = key_slots[moved].hash;
+				new_keys[moved].chain = key_slots[moved].chain;
+			}
+		} catch (...) {
+			for (size_t i = 0; i < moved; ++i) {
+				if (!live(i)) continue;
+				new_keys[i].key.~Key();
+				new_values[i].~T();
+			}
+			if (built) {
+				new_keys[used].key.~Key();
+				new_values[used].~T();
+			}
+			if (new_links) deallocate(new_links);
+			if (new_values) deallocate(new_values);
+			deallocate(new_keys);
+			throw;
+		}
+		destroy_slots();
+		key_slots = new_keys;
+		values = new_values;
+		links = new_links;
+		capacity = n;
+	}
+
+	// destroys the live keys and values and frees the slot arrays
+	void destroy_slots() {
+		for (size_t slot = first; slot != NIL; slot = links[slot].next) {
+			key_slots[slot].key.~Key();
+			values[slot].~T();
+		}
+		if (key_slots) deallocate(key_slots);
+		if (values) deallocate(values);
+		if (links) deallocate(links);
+		key_slots = nullptr;
+		values = nullptr;
+		links = nullptr;
+	}
+
+	size_t find_slot(const Key &key, size_t hash) const {
+		size_t slot = buckets[indexer(hash)];
+		while (slot != NIL) {
+			const KeySlot &k = key_slots[slot];
+			if (k.hash == hash && equal(k.key, key)) return slot;
+			slot = k.chain;
+		}
+		return NIL;
+	}
+
+	size_t find_slot(const Key &key) const {
+		return find_slot(key, hasher(key));
+	}
+
+	// a free slot, from the free list or the unused tail; not yet live.
+	// The arrays must have room: used < capacity or a free slot
+	size_t take_slot() {
+		if (free_slots != NIL) {
+			size_t slot = free_slots;
+			free_slots = key_slots[slot].chain;
+			return slot;
+		}
+		links[used].prev = DEAD;
+		return used++;
+	}
+
+	void give_back_slot(size_t slot) {
+		links[slot].prev = DEAD;
+		key_slots[slot].chain = free_slots;
+		free_slots = slot;
+	}
+
+	// appends key with a value constructed in place from args
+	template<class K, class... Args>
+	size_t insert_slot(size_t hash, K &&key, Args &&... args) {
+		if (element_count + 1 > bucket_size * LOAD_FACTOR) {
+			size_t grown = IndexPolicy::grow(bucket_size);
+			if (grown != bucket_size) rehash_to(grown);
+		}
+		size_t slot;
+		if (free_slots == NIL && used == capacity) {
+			grow_slots(capacity ? capacity * 2 : INITIAL_CAPACITY, std::forward<K>(key),
+			           std::forward<Args>(args)...);
+			slot = used++;
+		} else {
+			slot = take_slot();
+			try {
+				construct_slot(key_slots, values, slot, std::forward<K>(key), std::forward<Args>(args)...);
+			} catch (...) {
+				give_back_slot(slot);
+				throw;
+			}
+		}
+		size_t index = indexer(hash);
+		key_slots[slot].hash = hash;
+		key_slots[slot].chain = buckets[index];
+		buckets[index] = slot;
+
+		links[slot].prev = last;
+		links[slot].next = NIL;
+		if (last != NIL) links[last].next = slot;
+		else first = slot;
+		last = slot;
+		element_count++;
+		return slot;
+	}
+
+	void erase_slot(size_t slot) {
+		size_t *link = &buckets[indexer(key_slots[slot].hash)];
+		while (*link != slot) link = &key_slots[*link].chain;
+		*link = key_slots[slot].chain;
+
+		Link &l = links[slot];
+		if (l.prev != NIL) links[l.prev].next = l.next;
+		else first = l.next;
+		if (l.next != NIL) links[l.next].prev = l.prev;
+		else last = l.prev;
+
+		key_slots[slot].key.~Key();
+		values[slot].~T();
+		give_back_slot(slot);
+		element_count--;
+	}
+
+	void init_empty() {
+		key_slots = nullptr;
+		values = nullptr;
+		links = nullptr;
+		capacity = used = element_count = 0;
+		free_slots = first = last = NIL;
+		init_buckets(INITIAL_CAPACITY);
+	}
+
+public:
+	class const_iterator;
+	class iterator {
+	private:
+		size_t slot;
+		split_linked_hashmap *map;
+
+		friend class split_linked_hashmap;
+		friend class const_iterator;
+
+	public:
+		// operator-> needs an object to point to; the proxy lives here
+		struct arrow {
+			reference ref;
+			reference * operator->() { return &ref; }
+		};
+
+		using difference_type = std::ptrdiff_t;
+		using value_type = typename split_linked_hashmap::value_type;
+		using pointer = arrow;
+		using reference = typename split_linked_hashmap::reference;
+		using iterator_category = std::output_iterator_tag;
+
+		iterator() : slot(NIL), map(nullptr) {}
+		iterator(size_t s, split_linked_hashmap *m) : slot(s), map(m) {}
+
+		iterator & operator++() {
+			if (!map || slot == NIL) throw invalid_iterator();
+			slot = map->links[slot].next;
+			return *this;
+		}
+		iterator operator++(int) {
+			iterator temp = *this;
+			++*this;
+			return temp;
+		}
+		iterator & operator--() {
+			if (!map) throw invalid_iterator();
+			size_t prev = slot == NIL ? map->last : map->links[slot].prev;
+			if (prev == NIL) throw invalid_iterator();
+			slot = prev;
+			return *this;
+		}
+		iterator operator--(int) {
+			iterator temp = *this;
+			--*this;
+			return temp;
+		}
+
+		reference operator*() const {
+			return reference(map->key_slots[slot].key, map->values[slot]);
+		}
+		arrow operator->() const {
+			return arrow{**this};
+		}
+
+		bool operator==(const iterator &rhs) const { return slot == rhs.slot && map == rhs.map; }
+		bool operator==(const const_iterator &rhs) const { return slot == rhs.slot && map == rhs.map; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+	};
+
+	class const_iterator {
+	private:
+		size_t slot;
+		const split_linked_hashmap *map;
+
+		friend class split_linked_hashmap;
+		friend class iterator;
+
+	public:
+		struct arrow {
+			const_reference ref;
+			const_reference * operator->() { return &ref; }
+		};
+
+		using difference_type = std::ptrdiff_t;
+		using value_type = typename split_linked_hashmap::value_type;
+		using pointer = arrow;
+		using reference = const_reference;
+		using iterator_category = std::output_iterator_tag;
+
+		const_iterator() : slot(NIL), map(nullptr) {}
+		const_iterator(size_t s, const split_linked_hashmap *m) : slot(s), map(m) {}
+		const_iterator(const iterator &other) : slot(other.slot), map(other.map) {}
+
+		const_iterator & operator++() {
+			if (!map || slot == NIL) throw invalid_iterator();
+			slot = map->links[slot].next;
+			return *this;
+		}
+		const_iterator operator++(int) {
+			const_iterator temp = *this;
+			++*this;
+			return temp;
+		}
+		const_iterator & operator--() {
+			if (!map) throw invalid_iterator();
+			size_t prev = slot == NIL ? map->last : map->links[slot].prev;
+			if (prev == NIL) throw invalid_iterator();
+			slot = prev;
+			return *this;
+		}
+		const_iterator operator--(int) {
+			const_iterator temp = *this;
+			--*this;
+			return temp;
+		}
+
+		const_reference operator*() const {
+			return const_reference(map->key_slots[slot].key, map->values[slot]);
+		}
+		arrow operator->() const {
+			return arrow{**this};
+		}
+
+		bool operator==(const iterator &rhs) const { return slot == rhs.slot && map == rhs.map; }
+		bool operator==(const const_iterator &rhs) const { return slot == rhs.slot && map == rhs.map; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+	};
+
+	split_linked_hashmap() {
+		init_empty();
+	}
+
+	split_linked_hashmap(const split_linked_hashmap &other)
+		: hasher(other.hasher), equal(other.equal) {
+		init_empty();
+		try {
+			for (size_t slot = other.first; slot != NIL; slot = other.links[slot].next) {
+				insert_slot(other.key_slots[slot].hash, other.key_slots[slot].key, other.values[slot]);
+			}
+		} catch (...) {
+			destroy_slots();
+			delete[] buckets;
+			throw;
+		}
+	}
+
+	split_linked_hashmap & operator=(const split_linked_hashmap &other) {
+		if (this == &other) return *this;
+		clear();
+		for (size_t slot = other.first; slot != NIL; slot = other.links[slot].next) {
+			insert_slot(other.key_slots[slot].hash, other.key_slots[slot].key, other.values[slot]);
+		}
+		return *this;
+	}
+
+	~split_linked_hashmap() {
+		destroy_slots();
+		delete[] buckets;
+	}
+
+	/**
+	 * access specified element with bounds checking;
+	 * throw index_out_of_bound if the key does not exist.
+	 */
+	T & at(const Key &key) {
+		size_t slot = find_slot(key);
+		if (slot == NIL) throw index_out_of_bound();
+		return values[slot];
+	}
+
+	const T & at(const Key &key) const {
+		size_t slot = find_slot(key);
+		if (slot == NIL) throw index_out_of_bound();
+		return values[slot];
+	}
+
+	/**
+	 * access specified element, inserting a value-initialized value
+	 *   constructed in place if the key does not exist.
+	 */
+	T & operator[](const Key &key) {
+		// the insert may move the values array; index it afterwards
+		size_t slot = try_emplace(key).first.slot;
+		return values[slot];
+	}
+
+	T & operator[](Key &&key) {
+		size_t slot = try_emplace(std::move(key)).first.slot;
+		return values[slot];
+	}
+
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
+
+	iterator begin() { return iterator(first, this); }
+	const_iterator cbegin() const { return const_iterator(first, this); }
+	iterator end() { return iterator(NIL, this); }
+	const_iterator cend() const { return const_iterator(NIL, this); }
+
+	bool empty() const { return element_count == 0; }
+	size_t size() const { return element_count; }
+
+	void clear() {
+		destroy_slots();
+		capacity = used = element_count = 0;
+		free_slots = first = last = NIL;
+		for (size_t i = 0; i < bucket_size; ++i) buckets[i] = NIL;
+	}
+
+	/**
+	 * insert an element; see linked_hashmap::insert.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+		return try_emplace(value.first, value.second);
+	}
+
+	/**
+	 * insert an element, moving its value into the map; the key is const
+	 *   in value_type and is copied.
+	 */
+	pair<iterator, bool> insert(value_type &&value) {
+		return try_emplace(value.first, std::move(value.second));
+	}
+
+	/**
+	 * if key is absent, inserts it with a value constructed in place from
+	 *   args; otherwise leaves the map and args untouched. See
+	 *   linked_hashmap::try_emplace.
+	 */
+	template<class... Args>
+	pair<iterator, bool> try_emplace(const Key &key, Args &&... args) {
+		size_t hash = hasher(key);
+		size_t slot = find_slot(key, hash);
+		if (slot != NIL) return pair<iterator, bool>(iterator(slot, this), false);
+		slot = insert_slot(hash, key, std::forward<Args>(args)...);
+		return pair<iterator, bool>(iterator(slot, this), true);
+	}
+
+	template<class... Args>
+	pair<iterator, bool> try_emplace(Key &&key, Args &&... args) {
+		size_t hash = hasher(key);
+		size_t slot = find_slot(key, hash);
+		if (slot != NIL) return pair<iterator, bool>(iterator(slot, this), false);
+		slot = insert_slot(hash, std::move(key), std::forward<Args>(args)...);
+		return pair<iterator, bool>(iterator(slot, this), true);
+	}
+
+	/**
+	 * erase the element at pos; throw invalid_iterator if pos is end()
+	 *   or belongs to another map.
+	 */
+	void erase(iterator pos) {
+		if (pos.map != this || pos.slot == NIL || pos.slot >= used || !live(pos.slot)) {
+			throw invalid_iterator();
+		}
+		erase_slot(pos.slot);
+	}
+
+	/**
+	 * erase the element with key, if any; returns the number erased.
+	 */
+	size_t erase(const Key &key) {
+		size_t slot = find_slot(key);
+		if (slot == NIL) return 0;
+		erase_slot(slot);
+		return 1;
+	}
+
+	size_t count(const Key &key) const {
+		return find_slot(key) == NIL ? 0 : 1;
+	}
+
+	iterator find(const Key &key) {
+		return iterator(find_slot(key), this);
+	}
+
+	const_iterator find(const Key &key) const {
+		return const_iterator(find_slot(key), this);
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+/**
+ * per-thread linked_hashmaps for parallel ingestion, merged into one map
+ * in global first-insertion order.
+ *
+ *   sjtu::stamped_shards<Key, T> shards(threads);
+ *   // on thread t, for the rows i it was given
+ *   shards[t].insert(rows[i].key, rows[i].value, i);
+ *   // once every thread is done
+ *   sjtu::linked_hashmap<Key, T> result;
+ *   shards.merge_into(result);
+ *
+ * Every insert into a shard takes a stamp, normally from the caller: the
+ * position of the row in its input, so that the threads share nothing
+ * while they insert. Without one, insert() draws the stamp from a counter
+ * the shards share, one relaxed fetch_add per insert on a cache line all
+ * threads contend for; that is for inputs with no position of their own.
+ * A shard keeps the first value of a key and records the stamps of its
+ * elements in order. merge_into() then
+ * hands the shards to linked_hashmap::merge_stamped(), a k-way merge by
+ * stamp that moves whole nodes: result holds every key once, with the
+ * value of its smallest stamp, in the order of those stamps - the map a
+ * single thread inserting everything in stamp order would have built.
+ *
+ * Stamps must ascend within each shard, as they do from the shared
+ * counter. Shards only grow: they offer no erase.
+ */
+#ifndef SJTU_STAMPED_SHARDS_HPP
+#define SJTU_STAMPED_SHARDS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "linked_hashmap.hpp"
+
+namespace sjtu {
+
+template<class Key, class T, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class stamped_shards {
+public:
+	typedef linked_hashmap<Key, T, Hash, Equal> map_type;
+
+	class shard {
+		friend class stamped_shards;
+
+		map_type map;
+		std::vector<std::uint64_t> stamps;  // of the elements of map, in order
+		std::atomic<std::uint64_t> *clock;
+
+	public:
+		shard() : clock(nullptr) {}
+
+		/**
+		 * inserts key with value unless the shard has it already; returns
+		 *   whether it did. stamp places key in the merged order and must
+		 *   exceed the stamps of earlier inserts into this shard.
+		 */
+		bool insert(const Key &key, T value, std::uint64_t stamp) {
+			if (!map.try_emplace(key, std::move(value)).second) return false;
+			stamps.push_back(stamp);
+			return true;
+		}
+
+		/**
+		 * insert() stamped from the counter the shards share; every call
+		 *   increments it, inserted or not.
+		 */
+		bool insert(const Key &key, T value) {
+			return insert(key, std::move(value), clock->fetch_add(1, std::memory_order_relaxed));
+		}
+
+		// the shard's own elements, in insertion order
+		const map_type & elements() const {
+			return map;
+		}
+
+		size_t size() const {
+			return map.size();
+		}
+	};
+
+private:
+	std::vector<shard> shards;
+	std::atomic<std::uint64_t> clock;
+
+public:
+	explicit stamped_shards(size_t count) : shards(count), clock(0) {
+		for (size_t i = 0; i < count; ++i) shards[i].clock = &clock;
+	}
+
+	stamped_shards(const stamped_shards &) = delete;
+	stamped_shards & operator=(const stamped_shards &) = delete;
+
+	shard & operator[](size_t i) {
+		return shards[i];
+	}
+
+	size_t size() const {
+		return shards.size();
+	}
+
+	/**
+	 * moves the elements of every shard to the end of out in stamp order,
+	 *   keeping only the first of each key (and any key out already has);
+	 *   the shards are left empty and can be filled again.
+	 */
+	void merge_into(map_type &out) {
+		std::vector<map_type *> sources(shards.size());
+		std::vector<const std::uint64_t *> stamps(shards.size());
+		for (size_t i = 0; i < shards.size(); ++i) {
+			sources[i] = &shards[i].map;
+			stamps[i] = shards[i].stamps.data();
+		}
+		out.merge_stamped(sources.data(), stamps.data(), shards.size());
+		for (size_t i = 0; i < shards.size(); ++i) shards[i].stamps.clear();
+	}
+
+	// empties every shard
+	void clear() {
+		for (size_t i = 0; i < shards.size(); ++i) {
+			shards[i].map.clear();
+			shards[i].stamps.clear();
+		}
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * a minimal fork-join thread pool used by the parallel paths of
+ * linked_hashmap.
+ *
+ * run(tasks, fn) calls fn(i) for every i in [0, tasks) on the pool's
+ * workers and the calling thread, and returns once all calls are done.
+ * Tasks are handed out one at a time, so uneven tasks balance themselves.
+ * A pool may be shared, e.g. by several maps: concurrent run() calls from
+ * different threads take turns, each running its job to completion.
+ */
+#ifndef SJTU_THREAD_POOL_HPP
+#define SJTU_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sjtu {
+
+class thread_pool {
+private:
+	std::vector<std::thread> workers;
+	// held for the whole of a run(), so concurrent callers take turns
+	std::mutex running;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+
+	// the job currently being run, valid while busy > 0
+	const std::function<void(size_t)> *job;
+	size_t job_tasks;
+	std::atomic<size_t> next_task;
+	size_t generation;
+	size_t busy;
+	bool stopping;
+	std::exception_ptr error;
+
+	void work() {
+		size_t task;
+		while ((task = next_task.fetch_add(1)) < job_tasks) {
+			try {
+				(*job)(task);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!error) error = std::current_exception();
+			}
+		}
+	}
+
+	void worker_loop() {
+		size_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			wake.wait(lock, [&] { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+			lock.unlock();
+			work();
+			lock.lock();
+			if (--busy == 0) finished.notify_one();
+		}
+	}
+
+public:
+	/**
+	 * threads is the total parallelism, including the thread calling run();
+	 * 0 picks std::thread::hardware_concurrency().
+	 */
+	explicit thread_pool(size_t threads = 0)
+		: job(nullptr), job_tasks(0), next_task(0), generation(0), busy(0), stopping(false) {
+		if (threads == 0) threads = std::thread::hardware_concurrency();
+		if (threads == 0) threads = 1;
+		for (size_t i = 1; i < threads; ++i) {
+			workers.emplace_back([this] { worker_loop(); });
+		}
+	}
+
+	thread_pool(const thread_pool &) = delete;
+	thread_pool & operator=(const thread_pool &) = delete;
+
+	~thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+	}
+
+	/**
+	 * number of threads taking part in run(), the caller included.
+	 */
+	size_t size() const {
+		return workers.size() + 1;
+	}
+
+	/**
+	 * calls fn(i) for i in [0, tasks) in parallel and waits for all of them.
+	 * The first exception thrown by a task is rethrown here.
+	 * Safe to call from several threads at once; the calls are serialized.
+	 * Not reentrant: fn must not call run() on the same pool, which would
+	 *   deadlock.
+	 */
+	void run(size_t tasks, const std::function<void(size_t)> &fn) {
+		if (tasks == 0) return;
+		if (workers.empty() || tasks == 1) {
+			for (size_t i = 0; i < tasks; ++i) fn(i);
+			return;
+		}
+		std::lock_guard<std::mutex> turn(running);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			job = &fn;
+			job_tasks = tasks;
+			next_task.store(0);
+			error = nullptr;
+			busy = workers.size();
+			++generation;
+		}
+		wake.notify_all();
+		work();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [&] { return busy == 0; });
+		job = nullptr;
+		if (error) {
+			std::exception_ptr e = error;
+			error = nullptr;
+			std::rethrow_exception(e);
+		}
+	}
+};
+
+}
+
+#endif
@@ -1,12 +1,20 @@
 #ifndef SJTU_UTILITY_HPP
 #define SJTU_UTILITY_HPP
 
+#include <cstddef>
+#include <tuple>
 #include <utility>
 
 namespace sjtu {
 
 template<class T1, class T2>
 class pair {
+private:
+	template<class Tuple1, class Tuple2, std::size_t... I1, std::size_t... I2>
+	pair(Tuple1 &args1, Tuple2 &args2, std::index_sequence<I1...>, std::index_sequence<I2...>)
+		: first(std::forward<std::tuple_element_t<I1, Tuple1> >(std::get<I1>(args1))...),
+		  second(std::forward<std::tuple_element_t<I2, Tuple2> >(std::get<I2>(args2))...) {}
+
 public:
 	T1 first;
 	T2 second;
@@ -15,11 +23,19 @@ public:
 	pair(pair &&other) = default;
 	pair(const T1 &x, const T2 &y) : first(x), second(y) {}
 	template<class U1, class U2>
-	pair(U1 &&x, U2 &&y) : first(x), second(y) {}
+	pair(U1 &&x, U2 &&y) : first(std::forward<U1>(x)), second(std::forward<U2>(y)) {}
 	template<class U1, class U2>
 	pair(const pair<U1, U2> &other) : first(other.first), second(other.second) {}
 	template<class U1, class U2>
-	pair(pair<U1, U2> &&other) : first(other.first), second(other.second) {}
+	pair(pair<U1, U2> &&other) : first(std::forward<U1>(other.first)), second(std::forward<U2>(other.second)) {}
+	/**
+	 * constructs first from the elements of args1 and second from those
+	 *   of args2, e.g. pair(std::piecewise_construct,
+	 *   std::forward_as_tuple(key), std::forward_as_tuple()).
+	 */
+	template<class... Args1, class... Args2>
+	pair(std::piecewise_construct_t, std::tuple<Args1...> args1, std::tuple<Args2...> args2)
+		: pair(args1, args2, std::index_sequence_for<Args1...>(), std::index_sequence_for<Args2...>()) {}
 };
 
 }